@@ -106,6 +106,19 @@ export const IntersectionProvider = ({ children }) => {
         }
     };
 
+    // Applies several edits in one request; the device rolls all of them back if one fails.
+    const applyTopologyOps = async (ops) => {
+        setIsLoading(true);
+        try {
+            return await postJson('/topology_transaction', { ops });
+        } catch (error) {
+            console.error('Error applying topology transaction:', error);
+            throw error;
+        } finally {
+            setIsLoading(false);
+        }
+    };
+
     const discoverPeers = async () => {
         setIsLoading(true);
         try {
@@ -149,6 +162,7 @@ export const IntersectionProvider = ({ children }) => {
         addExternalPort,
         updateExternalPort,
         removeExternalPort,
+        applyTopologyOps,
         discoverPeers,
         openAddModal,
         closeAddModal,
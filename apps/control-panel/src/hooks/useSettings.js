@@ -96,6 +96,7 @@ const useSettings = () => {
     const LED_LIBRARIES = {
         0: 'NeoPixelBus',
         1: 'FastLED',
+        2: 'Virtual',
     };
 
     const OBJECT_TYPES = {
@@ -137,6 +138,8 @@ const useSettings = () => {
                 pixelPin1: 'pixel_pin1',
                 pixelPin2: 'pixel_pin2',
                 pixelDensity: 'pixel_density',
+                outputRefreshMs: 'output_refresh_ms',
+                simTickHz: 'sim_tick_hz',
                 ledType: 'led_type',
                 colorOrder: 'color_order',
                 ledLibrary: 'led_library',
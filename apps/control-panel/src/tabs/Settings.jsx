@@ -14,6 +14,8 @@ const SETTINGS_FIELD_KEYS = [
     'pixelPin1',
     'pixelPin2',
     'pixelDensity',
+    'outputRefreshMs',
+    'simTickHz',
     'ledType',
     'colorOrder',
     'ledLibrary',
@@ -57,6 +59,8 @@ const SettingsTab = () => {
         pixelPin1: 0,
         pixelPin2: 0,
         pixelDensity: 60,
+        outputRefreshMs: 1000,
+        simTickHz: 0,
         ledType: 0, // LED_WS2812
         colorOrder: 18, // CO_GRB
         ledLibrary: 1, // LIB_FASTLED
@@ -237,6 +241,8 @@ const SettingsTab = () => {
                 { key: 'pixelPin1', min: 0, max: 255 },
                 { key: 'pixelPin2', min: 0, max: 255 },
                 { key: 'pixelDensity', min: 1, max: 255 },
+                { key: 'outputRefreshMs', min: 0, max: 60000 },
+                { key: 'simTickHz', min: 0, max: 1000 },
                 { key: 'ledType', min: 0, max: 255 },
                 { key: 'colorOrder', min: 0, max: 255 },
                 { key: 'ledLibrary', min: 0, max: 255 },
@@ -556,6 +562,28 @@ const SettingsTab = () => {
                             className="w-full bg-zinc-600 border border-zinc-500 rounded px-3 py-2"
                         />
                     </div>
+                    <div>
+                        <label className="block text-sm text-zinc-300 mb-2">Idle Refresh (ms, 0 = off)</label>
+                        <input
+                            type="number"
+                            min="0"
+                            max="60000"
+                            value={settings.outputRefreshMs}
+                            onChange={(event) => updateIntegerSetting('outputRefreshMs', event.target.value, { min: 0, max: 60000 })}
+                            className="w-full bg-zinc-600 border border-zinc-500 rounded px-3 py-2"
+                        />
+                    </div>
+                    <div>
+                        <label className="block text-sm text-zinc-300 mb-2">Fixed Tick Rate (Hz, 0 = per frame)</label>
+                        <input
+                            type="number"
+                            min="0"
+                            max="1000"
+                            value={settings.simTickHz}
+                            onChange={(event) => updateIntegerSetting('simTickHz', event.target.value, { min: 0, max: 1000 })}
+                            className="w-full bg-zinc-600 border border-zinc-500 rounded px-3 py-2"
+                        />
+                    </div>
                     <div>
                         <label className="block text-sm text-zinc-300 mb-2">Color Order</label>
                         <select
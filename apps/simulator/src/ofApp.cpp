@@ -1,6 +1,28 @@
 #include "ofApp.h"
 
+#include <cstring>
+#include <fstream>
 #include <optional>
+#include <sstream>
+#include <unordered_map>
+#ifndef TARGET_WIN32
+#include <sys/resource.h>
+#endif
+
+// Peak resident set size of the process in KiB (0 where unavailable).
+static long peakRssKb() {
+#ifndef TARGET_WIN32
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef TARGET_OSX
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
 
 //--------------------------------------------------------------
 lightgraph::integration::Object* ofApp::createObject(ObjectType type, uint16_t pixelCount) {
@@ -24,20 +46,273 @@ lightgraph::integration::Object* ofApp::createObject(ObjectType type, uint16_t p
 //--------------------------------------------------------------
 void ofApp::setup(){
     ofSetFrameRate(62);
-    // Default to HeptagonStar for now but can be changed via key commands
-    object = createObject(OBJ_HEPTAGON919, HEPTAGON919_PIXEL_COUNT);
+    const char* tracePath = std::getenv(SIM_TRACE_ENV);
+    if (tracePath != nullptr && loadTrace(tracePath)) {
+        ofSeedRandom(traceSeed);
+        std::srand(traceSeed);
+        object = createObject(static_cast<ObjectType>(traceObjectType), tracePixelCount);
+    }
+    else {
+        // Default to HeptagonStar for now but can be changed via key commands
+        object = createObject(OBJ_HEPTAGON919, HEPTAGON919_PIXEL_COUNT);
+    }
     state = new lightgraph::integration::RuntimeState(*object);
     debugger = new lightgraph::integration::Debugger(*object);
     receiver.setup(OSC_PORT);
+    traceClockMs = traceStartMillis;
+    traceStartRssKb = peakRssKb();
+}
+
+//--------------------------------------------------------------
+template <typename T>
+static bool readTraceValue(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// Reads a trace written by the firmware TraceRecorder (see TraceRecorder.h for the layout).
+bool ofApp::loadTrace(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    uint8_t version = 0;
+    if (!in.read(magic, 4) || std::strncmp(magic, "MLTR", 4) != 0 ||
+        !readTraceValue(in, version) || version != 1 ||
+        !readTraceValue(in, traceObjectType) || !readTraceValue(in, tracePixelCount) ||
+        !readTraceValue(in, traceSeed) || !readTraceValue(in, traceStartMillis)) {
+        ofLogError() << "Trace: " << path << " is not a MeshLED trace";
+        return false;
+    }
+
+    uint8_t type = 0;
+    uint32_t offsetMs = 0;
+    uint16_t length = 0;
+    while (readTraceValue(in, type) && readTraceValue(in, offsetMs) && readTraceValue(in, length)) {
+        std::vector<char> payload(length);
+        if (!in.read(payload.data(), length)) {
+            break;
+        }
+        TraceEvent event;
+        event.type = type;
+        event.offsetMs = offsetMs;
+        event.command = 0;
+        size_t pos = 0;
+        if (type == 1 && length > 0) {
+            const uint8_t addressLength = payload[pos++];
+            event.message.setAddress(std::string(payload.data() + pos, addressLength));
+            pos += addressLength;
+            const uint8_t argCount = payload[pos++];
+            for (uint8_t i=0; i<argCount && pos + 5 <= length; i++) {
+                const char tag = payload[pos++];
+                if (tag == 'f') {
+                    float value;
+                    std::memcpy(&value, payload.data() + pos, sizeof(value));
+                    event.message.addFloatArg(value);
+                }
+                else {
+                    int32_t value;
+                    std::memcpy(&value, payload.data() + pos, sizeof(value));
+                    event.message.addIntArg(value);
+                }
+                pos += 4;
+            }
+        }
+        else if (type == 2 && length > 0) {
+            // u8 uri length, uri, u16 args length, "name=value&..." (values unescaped)
+            const uint8_t uriLength = payload[pos++];
+            event.uri.assign(payload.data() + pos, std::min<size_t>(uriLength, length - pos));
+            pos += uriLength;
+            if (pos + 2 <= length) {
+                uint16_t argsLength = 0;
+                std::memcpy(&argsLength, payload.data() + pos, sizeof(argsLength));
+                pos += 2;
+                std::istringstream args(std::string(payload.data() + pos, std::min<size_t>(argsLength, length - pos)));
+                std::string pair;
+                while (std::getline(args, pair, '&')) {
+                    const size_t eq = pair.find('=');
+                    if (eq != std::string::npos) {
+                        event.args[pair.substr(0, eq)] = pair.substr(eq + 1);
+                    }
+                }
+            }
+        }
+        else if (type == 3 && length > 0) {
+            event.command = payload[0];
+        }
+        traceEvents.push_back(event);
+    }
+
+    ofLogNotice() << "Trace: loaded " << traceEvents.size() << " events from " << path
+                  << " (seed " << traceSeed << ")";
+    return !traceEvents.empty();
+}
+
+// Applies every event whose offset the logical trace clock has reached.
+void ofApp::replayTrace() {
+    const uint64_t offsetMs = traceClockMs - traceStartMillis;
+    while (traceNext < traceEvents.size() && traceEvents[traceNext].offsetMs <= offsetMs) {
+        const TraceEvent& event = traceEvents[traceNext++];
+        switch (event.type) {
+            case 1:
+                if (!dispatchOsc(event.message)) {
+                    traceSkippedOsc++;
+                }
+                break;
+            case 2:
+                if (!replayHttp(event)) {
+                    traceSkippedHttp++;
+                }
+                break;
+            case 3:
+                doCommand(event.command);
+                break;
+            default:
+                break;
+        }
+    }
+    if (traceNext == traceEvents.size()) {
+        reportTrace();
+        traceNext++;
+    }
+}
+
+// Applies the layer mutations of a recorded HTTP request with the same bounds as
+// the firmware handlers (WebServerLayers.h). Returns false for routes that only
+// touch firmware state (settings, topology, palettes) or need firmware tables.
+bool ofApp::replayHttp(const TraceEvent& event) {
+    const auto arg = [&event](const char* name) -> const std::string* {
+        const auto found = event.args.find(name);
+        return found != event.args.end() ? &found->second : nullptr;
+    };
+
+    if (event.uri == "/toggle_auto") {
+        state->autoEnabled = !state->autoEnabled;
+        return true;
+    }
+    if (event.uri == "/add_layer") {
+        for (uint8_t i=0; i<MAX_LIGHT_LISTS; i++) {
+            if (!state->lightLists[i]) {
+                state->setupBg(i);
+                break;
+            }
+        }
+        return true;
+    }
+
+    const std::string* layerArg = arg("layer");
+    if (layerArg == nullptr) {
+        return false;
+    }
+    const int layer = ofToInt(*layerArg);
+    auto* list = layer >= 0 && layer < MAX_LIGHT_LISTS ? state->lightLists[layer] : nullptr;
+
+    if (event.uri == "/toggle_visible") {
+        if (list && arg("visible")) list->visible = *arg("visible") == "true";
+    }
+    else if (event.uri == "/update_layer_brightness") {
+        const int value = arg("value") ? ofToInt(*arg("value")) : 0;
+        if (list && value >= 1 && value <= 255) {
+            list->maxBri = value;
+            if (list->minBri > value) list->minBri = value;
+        }
+    }
+    else if (event.uri == "/remove_layer") {
+        if (list && layer != 0 && list->editable) list->setDuration(0);
+    }
+    else if (event.uri == "/update_speed") {
+        const float value = arg("value") ? ofToFloat(*arg("value")) : 0.f;
+        if (list && value >= -10.f && value <= 10.f) list->setSpeed(value, list->easeIndex);
+    }
+    else if (event.uri == "/update_fade_speed") {
+        if (list && arg("value")) list->setFade(ofToInt(*arg("value")), list->fadeThresh, list->fadeEaseIndex);
+    }
+    else if (event.uri == "/update_ease") {
+        const int ease = arg("ease") ? ofToInt(*arg("ease")) : -1;
+        if (list && ease >= EASE_NONE && ease <= EASE_ELASTIC_INOUT) list->setSpeed(list->speed, ease);
+    }
+    else if (event.uri == "/update_blend_mode") {
+        const int mode = arg("mode") ? ofToInt(*arg("mode")) : -1;
+        if (list && mode >= BLEND_NORMAL && mode <= BLEND_PIN_LIGHT) {
+            list->blendMode = static_cast<decltype(list->blendMode)>(mode);
+        }
+    }
+    else if (event.uri == "/update_layer_offset") {
+        if (list && arg("offset")) list->setOffset(ofToFloat(*arg("offset")));
+    }
+    else if (event.uri == "/reset_layer") {
+        if (list) list->reset();
+    }
+    else {
+        // /update_palette and /update_behaviour_flags need the firmware palette
+        // tables and layer conversion; everything else is firmware-only state.
+        return false;
+    }
+    return true;
+}
+
+void ofApp::reportTrace() {
+    const double avgMicros = traceFrames > 0 ? static_cast<double>(traceUpdateMicros) / traceFrames : 0.0;
+    const long rssKb = peakRssKb();
+    ofLogNotice() << "Trace: replay finished after " << traceFrames << " frames"
+                  << ", update avg " << avgMicros << "us max " << traceMaxUpdateMicros << "us"
+                  << ", peak lights " << tracePeakLights << " lists " << tracePeakLightLists
+                  << ", peak RSS " << rssKb << " KiB (+" << (rssKb - traceStartRssKb) << " KiB during replay)"
+                  << ", skipped HTTP events " << traceSkippedHttp
+                  << ", skipped OSC events " << traceSkippedOsc;
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
-    updateOsc();
+    const bool tracing = !traceEvents.empty() && traceNext <= traceEvents.size();
+    const uint64_t updateStartedAt = ofGetElapsedTimeMicros();
+    if (tracing) {
+        replayTrace();
+    }
+    else {
+        updateOsc();
+    }
 
-    state->autoEmit(ofGetElapsedTimeMillis());
-    gMillis = ofGetElapsedTimeMillis();
     state->lightLists[0]->visible = showAll;
+    if (!traceEvents.empty()) {
+        // A loaded trace drives time as well as input: the logical clock moves by
+        // a fixed step per update, so two replays compute the same frames.
+        stepState(traceClockMs);
+        traceClockMs += SIM_TRACE_STEP_MS;
+    }
+    else {
+#if SIM_TICK_HZ > 0
+        // Compiled only with a tick rate so the divisions below never see a zero.
+        const uint64_t nowMicros = ofGetElapsedTimeMicros();
+        const uint64_t tickMicros = 1000000ULL / SIM_TICK_HZ;
+        simAccumulatorMicros += nowMicros - simLastMicros;
+        simLastMicros = nowMicros;
+
+        uint8_t steps = 0;
+        while (simAccumulatorMicros >= tickMicros && steps < SIM_MAX_CATCHUP_TICKS) {
+            simAccumulatorMicros -= tickMicros;
+            simLogicalMicros += tickMicros;
+            stepState(simLogicalMicros / 1000ULL);
+            steps++;
+        }
+        if (simAccumulatorMicros >= tickMicros) {
+            simAccumulatorMicros %= tickMicros;
+        }
+#else
+        stepState(ofGetElapsedTimeMillis());
+#endif
+    }
+
+    if (tracing) {
+        const uint64_t updateMicros = ofGetElapsedTimeMicros() - updateStartedAt;
+        traceFrames++;
+        traceUpdateMicros += updateMicros;
+        traceMaxUpdateMicros = std::max(traceMaxUpdateMicros, updateMicros);
+        tracePeakLights = std::max<uint16_t>(tracePeakLights, state->totalLights);
+        tracePeakLightLists = std::max<uint16_t>(tracePeakLightLists, state->totalLightLists);
+    }
+}
+
+void ofApp::stepState(uint64_t millis){
+    state->autoEmit(millis);
+    gMillis = millis;
     state->update();
 }
 
@@ -46,26 +321,43 @@ void ofApp::updateOsc(){
     {
         ofxOscMessage m;
         receiver.getNextMessage(m);
-        if (m.getAddress() == "/emit") {
-            onEmit(m);
-        }
-        else if (m.getAddress() == "/note_on"){
-            onNoteOn(m);
-        }
-        else if (m.getAddress() == "/note_off"){
-            onNoteOff(m);
-        }
-        else if (m.getAddress() == "/notes_set"){
-            onNotesSet(m);
-        }
-        else if (m.getAddress() == "/auto"){
-            onAuto(m);
-        }
-        else if (m.getAddress() == "/command") {
-            onCommand(m);
-        }
+        dispatchOsc(m);
+    }
+}
 
+// Returns false for addresses the simulator does not handle.
+bool ofApp::dispatchOsc(const ofxOscMessage& m){
+    if (m.getAddress() == "/emit") {
+        onEmit(m);
+    }
+    else if (m.getAddress() == "/note_on"){
+        onNoteOn(m);
+    }
+    else if (m.getAddress() == "/note_off"){
+        onNoteOff(m);
     }
+    else if (m.getAddress() == "/notes_set"){
+        onNotesSet(m);
+    }
+    else if (m.getAddress() == "/auto"){
+        onAuto(m);
+    }
+    else if (m.getAddress() == "/palette"){
+        onPalette(m);
+    }
+    else if (m.getAddress() == "/color"){
+        onColor(m);
+    }
+    else if (m.getAddress() == "/split"){
+        onSplit(m);
+    }
+    else if (m.getAddress() == "/command") {
+        onCommand(m);
+    }
+    else {
+        return false;
+    }
+    return true;
 }
 
 void ofApp::onCommand(const ofxOscMessage& m) {
@@ -124,6 +416,46 @@ void ofApp::onAuto(const ofxOscMessage &m) {
   state->autoEnabled = !state->autoEnabled;
 }
 
+void ofApp::onPalette(const ofxOscMessage &m) {
+  if (m.getNumArgs() > 0) {
+    state->currentPalette = m.getArgAsInt(0);
+  }
+}
+
+void ofApp::onColor(const ofxOscMessage &m) {
+  if (m.getNumArgs() == 0) {
+    state->colorAll();
+    return;
+  }
+  const int i = m.getArgAsInt(0);
+  if (i < 0 || i >= MAX_LIGHT_LISTS || !state->lightLists[i]) {
+    return;
+  }
+  std::vector<ColorRGB> colors;
+  for (size_t j = 1; j < m.getNumArgs(); j++) {
+    ColorRGB color;
+    color.set(static_cast<uint32_t>(m.getArgAsInt(j)));
+    colors.push_back(color);
+  }
+  if (colors.empty()) {
+    ColorRGB color;
+    color.setRandom();
+    colors.push_back(color);
+  }
+  state->lightLists[i]->palette.setColors(colors);
+}
+
+void ofApp::onSplit(const ofxOscMessage &m) {
+  if (m.getNumArgs() == 0) {
+    state->splitAll();
+    return;
+  }
+  const int i = m.getArgAsInt(0);
+  if (i >= 0 && i < MAX_LIGHT_LISTS && state->lightLists[i]) {
+    state->lightLists[i]->split();
+  }
+}
+
 void ofApp::parseParams(lightgraph::integration::EmitParams &p, const ofxOscMessage &m) {
     for (uint8_t i=0; i<m.getNumArgs() / 2; i++) {
         lightgraph::integration::EmitParam param = static_cast<lightgraph::integration::EmitParam>(m.getArgAsInt(i*2));
@@ -354,13 +686,22 @@ void ofApp::draw(){
 
     uint16_t size = 3;
 
+    // Intersection positions are resolved once per frame; connections look their
+    // endpoints up here instead of scanning their group for each end.
+    std::unordered_map<const lightgraph::integration::Intersection*, glm::vec2> positions;
+    for (uint8_t i=0; i<MAX_GROUPS; i++) {
+        for (size_t j=0; j<object->inter[i].size(); j++) {
+            positions[object->inter[i][j]] = intersectionPos(object->inter[i][j], static_cast<int>(j));
+        }
+    }
+
     ofPushMatrix();
     ofTranslate(ofGetWidth()/2, ofGetHeight()/2);
     for (uint8_t i=0; i<MAX_GROUPS; i++) {
         if (object->inter[i].size() > 0) {
-            for (uint8_t j=0; j<object->inter[i].size(); j++) {
+            for (size_t j=0; j<object->inter[i].size(); j++) {
                 ofSetColor(getColor(object->inter[i][j]->topPixel));
-                glm::vec2 point = intersectionPos(object->inter[i][j], j);
+                glm::vec2 point = positions[object->inter[i][j]];
                 ofDrawCircle(point, size);
                 if (showPixels) {
                     ofSetColor(255);
@@ -369,10 +710,12 @@ void ofApp::draw(){
             }
         }
         if (object->conn[i].size() > 0) {
-            for (uint8_t j=0; j<object->conn[i].size(); j++) {
+            for (size_t j=0; j<object->conn[i].size(); j++) {
                 lightgraph::integration::Connection* conn = object->conn[i][j];
-                glm::vec2 fromPos = intersectionPos(conn->from);
-                glm::vec2 toPos = intersectionPos(conn->to);
+                auto fromIt = positions.find(conn->from);
+                auto toIt = positions.find(conn->to);
+                glm::vec2 fromPos = fromIt != positions.end() ? fromIt->second : intersectionPos(conn->from);
+                glm::vec2 toPos = toIt != positions.end() ? toIt->second : intersectionPos(conn->to);
                 float dist = glm::distance(fromPos, toPos);
                 for (uint16_t k=0; k<conn->numLeds; k++) {
                     glm::vec2 point = glm::mix(fromPos, toPos, (float) (k+1)/(conn->numLeds+1));
@@ -406,7 +749,7 @@ void ofApp::draw(){
 
 }
 
-glm::vec2 ofApp::intersectionPos(lightgraph::integration::Intersection* intersection, int8_t j) {
+glm::vec2 ofApp::intersectionPos(lightgraph::integration::Intersection* intersection, int j) {
     uint16_t groupDiam[MAX_GROUPS] = {0};
 
     if (currentObjectType == OBJ_HEPTAGON919 || currentObjectType == OBJ_HEPTAGON3024) {
@@ -427,7 +770,7 @@ glm::vec2 ofApp::intersectionPos(lightgraph::integration::Intersection* intersec
 
     uint8_t i = log2(intersection->group);
     if (j<0) {
-        for (j=0; j<object->inter[i].size(); j++) {
+        for (j=0; j<static_cast<int>(object->inter[i].size()); j++) {
             if (object->inter[i][j] == intersection) {
                 break;
             }
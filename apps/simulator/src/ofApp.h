@@ -5,9 +5,25 @@
 #include "lightgraph/integration.hpp"
 #define OSC_PORT 54321
 #define MAX_BRIGHTNESS 255
+// Fixed-timestep state updates in Hz; 0 keeps one update per frame.
+#define SIM_TICK_HZ 0
+#define SIM_MAX_CATCHUP_TICKS 4
+// Environment variable pointing at a firmware input trace (/trace/download) to replay.
+#define SIM_TRACE_ENV "MESHLED_TRACE"
+// Logical ms per update while replaying a trace, so replays are frame-for-frame repeatable.
+#define SIM_TRACE_STEP_MS 16
 
 glm::vec2 pointOnEllipse(float rad, float w, float h);
 
+struct TraceEvent {
+    uint8_t type;
+    uint32_t offsetMs;
+    ofxOscMessage message;
+    char command;
+    std::string uri;
+    std::map<std::string, std::string> args;
+};
+
 class ofApp : public ofBaseApp{
 
 public:
@@ -41,19 +57,28 @@ public:
     void gotMessage(ofMessage msg);
 
     void updateOsc();
+    bool dispatchOsc(const ofxOscMessage& m);
+    bool loadTrace(const std::string& path);
+    void replayTrace();
+    bool replayHttp(const TraceEvent& event);
+    void reportTrace();
     void onCommand(const ofxOscMessage& m);
     void onEmit(const ofxOscMessage& m);
     void onNoteOn(const ofxOscMessage& m);
     void onNoteOff(const ofxOscMessage& m);
     void onNotesSet(const ofxOscMessage& m);
     void onAuto(const ofxOscMessage& m);
+    void onPalette(const ofxOscMessage& m);
+    void onColor(const ofxOscMessage& m);
+    void onSplit(const ofxOscMessage& m);
     void parseParams(lightgraph::integration::EmitParams &p, const ofxOscMessage &m);
     void parseParam(lightgraph::integration::EmitParams &p, const ofxOscMessage &m, lightgraph::integration::EmitParam &param, uint8_t j);
     void doCommand(char command);
-    glm::vec2 intersectionPos(lightgraph::integration::Intersection* intersection, int8_t j = -1);
+    glm::vec2 intersectionPos(lightgraph::integration::Intersection* intersection, int j = -1);
     lightgraph::integration::Object* createObject(ObjectType type, uint16_t pixelCount);
     ofColor getColor(uint16_t i);
     void doEmit(lightgraph::integration::EmitParams &params);
+    void stepState(uint64_t millis);
 
     ofxOscReceiver receiver;
     uint8_t showModel = 0;
@@ -62,5 +87,24 @@ public:
     bool showHeap = false;
     bool showPixels = false;
     int8_t lastList = -1;
+    uint64_t simLastMicros = 0;
+    uint64_t simAccumulatorMicros = 0;
+    uint64_t simLogicalMicros = 0;
+
+    std::vector<TraceEvent> traceEvents;
+    size_t traceNext = 0;
+    uint32_t traceSeed = 0;
+    uint8_t traceObjectType = OBJ_HEPTAGON919;
+    uint16_t tracePixelCount = HEPTAGON919_PIXEL_COUNT;
+    uint32_t traceSkippedHttp = 0;
+    uint32_t traceSkippedOsc = 0;
+    uint32_t traceStartMillis = 0;
+    uint64_t traceClockMs = 0;
+    uint64_t traceFrames = 0;
+    uint64_t traceUpdateMicros = 0;
+    uint64_t traceMaxUpdateMicros = 0;
+    uint16_t tracePeakLights = 0;
+    uint16_t tracePeakLightLists = 0;
+    long traceStartRssKb = 0;
 
 };
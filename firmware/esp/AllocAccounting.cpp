@@ -0,0 +1,83 @@
+#include "AllocAccounting.h"
+
+#ifdef ALLOC_ACCOUNTING_ENABLED
+
+#include <esp_heap_caps.h>
+
+// Linker wrappers for the *-alloc environments (see AllocAccounting.h). They
+// are plain extern "C" definitions, so they live in exactly one translation unit.
+//
+// realloc() follows the C semantics: a null pointer allocates, a zero size
+// frees, and a resize counts as one allocation whose net effect is the change
+// in block size.
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+static void allocAccountingRecordAlloc(void* ptr) {
+  gAllocCount++;
+  if (ptr != nullptr) {
+    gAllocBytes += heap_caps_get_allocated_size(ptr);
+  }
+}
+
+static void allocAccountingRecordFree(void* ptr) {
+  if (ptr != nullptr) {
+    gAllocFreeCount++;
+    gAllocFreedBytes += heap_caps_get_allocated_size(ptr);
+  }
+}
+
+void* __wrap_malloc(size_t size) {
+  void* ptr = __real_malloc(size);
+  if (isAllocAccountingTask()) {
+    allocAccountingRecordAlloc(ptr);
+  }
+  return ptr;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  void* ptr = __real_calloc(count, size);
+  if (isAllocAccountingTask()) {
+    allocAccountingRecordAlloc(ptr);
+  }
+  return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  if (!isAllocAccountingTask()) {
+    return __real_realloc(ptr, size);
+  }
+  if (ptr == nullptr) {
+    void* allocated = __real_realloc(nullptr, size);
+    allocAccountingRecordAlloc(allocated);
+    return allocated;
+  }
+  if (size == 0) {
+    allocAccountingRecordFree(ptr);
+    return __real_realloc(ptr, 0);
+  }
+
+  const size_t oldSize = heap_caps_get_allocated_size(ptr);
+  void* resized = __real_realloc(ptr, size);
+  gAllocCount++;
+  if (resized != nullptr) {
+    // Net effect only: the old block is released, the new one is held.
+    gAllocBytes += heap_caps_get_allocated_size(resized);
+    gAllocFreedBytes += oldSize;
+  }
+  return resized;
+}
+
+void __wrap_free(void* ptr) {
+  if (isAllocAccountingTask()) {
+    allocAccountingRecordFree(ptr);
+  }
+  __real_free(ptr);
+}
+}
+
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+
+// Allocation accounting for the loop task. Built by the *-alloc PlatformIO
+// environments, which define ALLOC_ACCOUNTING_ENABLED and link with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free so every heap
+// allocation and free made from the Arduino loop task (operator new/delete,
+// String, std::vector) is counted; the wrappers live in AllocAccounting.cpp.
+// Byte counters use the heap's block sizes, so `bytes` is what was allocated
+// and `netBytes` what is still held once frees are subtracted. AllocScope
+// attributes the activity while it is alive to a phase, so /ota_status can
+// show whether steady-state State::update() stays allocation free and what
+// each ingress message costs.
+
+enum AllocPhase : uint8_t {
+  ALLOC_PHASE_UPDATE = 0,
+  ALLOC_PHASE_OSC = 1,
+  ALLOC_PHASE_HTTP = 2,
+  ALLOC_PHASE_ESPNOW = 3,
+  ALLOC_PHASE_COUNT = 4,
+};
+
+#ifdef ALLOC_ACCOUNTING_ENABLED
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+struct AllocPhaseStats {
+  uint32_t calls = 0;
+  uint32_t callsWithAllocs = 0;
+  uint32_t allocs = 0;
+  uint32_t frees = 0;
+  uint32_t bytes = 0;
+  int32_t netBytes = 0;
+  uint32_t maxAllocsPerCall = 0;
+  uint32_t lastAllocs = 0;
+  int32_t lastNetBytes = 0;
+};
+
+inline TaskHandle_t gAllocLoopTask = nullptr;
+inline volatile uint32_t gAllocCount = 0;
+inline volatile uint32_t gAllocFreeCount = 0;
+inline volatile uint32_t gAllocBytes = 0;
+inline volatile uint32_t gAllocFreedBytes = 0;
+inline AllocPhaseStats gAllocPhaseStats[ALLOC_PHASE_COUNT];
+
+inline bool isAllocAccountingTask() {
+  return gAllocLoopTask != nullptr && xTaskGetCurrentTaskHandle() == gAllocLoopTask;
+}
+
+// Call from setup(); only allocations made by the calling (loop) task are counted.
+inline void initAllocAccounting() {
+  gAllocLoopTask = xTaskGetCurrentTaskHandle();
+}
+
+inline const char* allocPhaseName(uint8_t phase) {
+  switch (phase) {
+    case ALLOC_PHASE_UPDATE:
+      return "update";
+    case ALLOC_PHASE_OSC:
+      return "osc";
+    case ALLOC_PHASE_HTTP:
+      return "http";
+    case ALLOC_PHASE_ESPNOW:
+      return "espnow";
+  }
+  return "unknown";
+}
+
+struct AllocScope {
+  AllocPhase phase;
+  uint32_t startCount;
+  uint32_t startFrees;
+  uint32_t startBytes;
+  uint32_t startFreedBytes;
+
+  explicit AllocScope(AllocPhase phase)
+      : phase(phase),
+        startCount(gAllocCount),
+        startFrees(gAllocFreeCount),
+        startBytes(gAllocBytes),
+        startFreedBytes(gAllocFreedBytes) {}
+
+  ~AllocScope() {
+    AllocPhaseStats& stats = gAllocPhaseStats[phase];
+    const uint32_t allocs = gAllocCount - startCount;
+    const uint32_t bytes = gAllocBytes - startBytes;
+    const int32_t netBytes = static_cast<int32_t>(bytes - (gAllocFreedBytes - startFreedBytes));
+    stats.calls++;
+    stats.allocs += allocs;
+    stats.frees += gAllocFreeCount - startFrees;
+    stats.bytes += bytes;
+    stats.netBytes += netBytes;
+    stats.lastAllocs = allocs;
+    stats.lastNetBytes = netBytes;
+    if (allocs > 0) {
+      stats.callsWithAllocs++;
+    }
+    if (allocs > stats.maxAllocsPerCall) {
+      stats.maxAllocsPerCall = allocs;
+    }
+  }
+
+  AllocScope(const AllocScope&) = delete;
+  AllocScope& operator=(const AllocScope&) = delete;
+};
+
+#else
+
+inline void initAllocAccounting() {}
+
+struct AllocScope {
+  explicit AllocScope(AllocPhase) {}
+};
+
+#endif
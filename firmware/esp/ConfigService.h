@@ -40,9 +40,29 @@ struct SettingsPatch {
   bool hasPixelPin2 = false;
   uint8_t pixelPin2 = 0;
 
+  // Strips past 2 (pixel_count3, pixel_pin3, ...) and the per-strip led_typeN /
+  // color_orderN overrides, indexed from 0 for strip 1.
+  bool hasStripPixelCount[OUTPUT_MAX_STRIPS] = {};
+  uint16_t stripPixelCount[OUTPUT_MAX_STRIPS] = {};
+
+  bool hasStripPin[OUTPUT_MAX_STRIPS] = {};
+  uint8_t stripPin[OUTPUT_MAX_STRIPS] = {};
+
+  bool hasStripLedType[OUTPUT_MAX_STRIPS] = {};
+  uint8_t stripLedType[OUTPUT_MAX_STRIPS] = {};
+
+  bool hasStripColorOrder[OUTPUT_MAX_STRIPS] = {};
+  uint8_t stripColorOrder[OUTPUT_MAX_STRIPS] = {};
+
   bool hasPixelDensity = false;
   uint8_t pixelDensity = 0;
 
+  bool hasOutputRefreshMs = false;
+  uint16_t outputRefreshMs = 0;
+
+  bool hasSimTickHz = false;
+  uint16_t simTickHz = 0;
+
   bool hasLedLibrary = false;
   uint8_t ledLibrary = 0;
 
@@ -236,6 +256,41 @@ inline bool parseSettingsPatch(SettingsPatch& patch, String& error) {
     patch.pixelPin2 = static_cast<uint8_t>(parsedLong);
   }
 
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    const String suffix = String(i + 1);
+    if (i >= 2) {
+      if (!parseBoundedLongArg(("pixel_count" + suffix).c_str(), 0, 65535, parsedLong,
+                               patch.hasStripPixelCount[i], error)) {
+        return false;
+      }
+      if (patch.hasStripPixelCount[i]) {
+        patch.stripPixelCount[i] = static_cast<uint16_t>(parsedLong);
+      }
+
+      if (!parseBoundedLongArg(("pixel_pin" + suffix).c_str(), 0, 255, parsedLong, patch.hasStripPin[i], error)) {
+        return false;
+      }
+      if (patch.hasStripPin[i]) {
+        patch.stripPin[i] = static_cast<uint8_t>(parsedLong);
+      }
+    }
+
+    if (!parseBoundedLongArg(("led_type" + suffix).c_str(), 0, 255, parsedLong, patch.hasStripLedType[i], error)) {
+      return false;
+    }
+    if (patch.hasStripLedType[i]) {
+      patch.stripLedType[i] = static_cast<uint8_t>(parsedLong);
+    }
+
+    if (!parseBoundedLongArg(("color_order" + suffix).c_str(), 0, 255, parsedLong,
+                             patch.hasStripColorOrder[i], error)) {
+      return false;
+    }
+    if (patch.hasStripColorOrder[i]) {
+      patch.stripColorOrder[i] = static_cast<uint8_t>(parsedLong);
+    }
+  }
+
   if (!parseBoundedLongArg("pixel_density", 1, 255, parsedLong, patch.hasPixelDensity, error)) {
     return false;
   }
@@ -243,6 +298,20 @@ inline bool parseSettingsPatch(SettingsPatch& patch, String& error) {
     patch.pixelDensity = static_cast<uint8_t>(parsedLong);
   }
 
+  if (!parseBoundedLongArg("output_refresh_ms", 0, 60000, parsedLong, patch.hasOutputRefreshMs, error)) {
+    return false;
+  }
+  if (patch.hasOutputRefreshMs) {
+    patch.outputRefreshMs = static_cast<uint16_t>(parsedLong);
+  }
+
+  if (!parseBoundedLongArg("sim_tick_hz", 0, 1000, parsedLong, patch.hasSimTickHz, error)) {
+    return false;
+  }
+  if (patch.hasSimTickHz) {
+    patch.simTickHz = static_cast<uint16_t>(parsedLong);
+  }
+
   if (!parseBoundedLongArg("led_library", 0, 255, parsedLong, patch.hasLedLibrary, error)) {
     return false;
   }
@@ -354,10 +423,55 @@ inline bool applySettingsPatch(const SettingsPatch& patch, SettingsApplyResult&
     result.needsLedReinit = true;
   }
 
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    OutputStripConfig& output = outputs[i];
+    if (patch.hasStripPixelCount[i] && patch.stripPixelCount[i] != output.pixelCount) {
+      output.pixelCount = patch.stripPixelCount[i];
+      result.needsLedReinit = true;
+      result.needsStateRebuild = true;
+    }
+
+    if (patch.hasStripPin[i] && patch.stripPin[i] != output.pin) {
+      output.pin = patch.stripPin[i];
+      result.needsLedReinit = true;
+    }
+
+    // OUTPUT_INHERIT (255) drops the override and follows led_type/color_order.
+    if (patch.hasStripLedType[i]) {
+      if (patch.stripLedType[i] != OUTPUT_INHERIT && !isLedTypeKnown(patch.stripLedType[i])) {
+        error = "Unsupported led_type" + String(i + 1);
+        return false;
+      }
+      if (patch.stripLedType[i] != output.ledType) {
+        output.ledType = patch.stripLedType[i];
+        result.needsLedReinit = true;
+      }
+    }
+
+    if (patch.hasStripColorOrder[i]) {
+      if (patch.stripColorOrder[i] != OUTPUT_INHERIT && !isColorOrderSupportedValue(patch.stripColorOrder[i])) {
+        error = "Unsupported color_order" + String(i + 1);
+        return false;
+      }
+      if (patch.stripColorOrder[i] != output.colorOrder) {
+        output.colorOrder = patch.stripColorOrder[i];
+        result.needsLedReinit = true;
+      }
+    }
+  }
+
   if (patch.hasPixelDensity) {
     pixelDensity = patch.pixelDensity;
   }
 
+  if (patch.hasOutputRefreshMs) {
+    outputRefreshMs = patch.outputRefreshMs;
+  }
+
+  if (patch.hasSimTickHz) {
+    simTickHz = patch.simTickHz;
+  }
+
   if (patch.hasLedLibrary) {
     if (!isLedLibraryKnown(patch.ledLibrary)) {
       error = "Unsupported led_library";
@@ -430,6 +544,15 @@ inline bool applySettingsPatch(const SettingsPatch& patch, SettingsApplyResult&
 
   normalizeLedSelection();
 
+  // Checked once the library is settled, since led_type and led_library in the
+  // same request can change it.
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    if (patch.hasStripLedType[i] && patch.stripLedType[i] != outputs[i].ledType) {
+      error = "led_type" + String(i + 1) + " is not supported by " + String(ledLibraryName(ledLibrary));
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Auto-connect search used by recalculateConnections(). It only reads topPixel
+// and bottomPixel (-1 when the intersection has none), so it has no Arduino or
+// core dependency and the host tests can run it on plain structs.
+//
+// Two intersections of a group may be connected when no other intersection of
+// the group lies on the strip between them: a testInter whose topPixel is
+// strictly between theirs blocks, unless all three have a bottomPixel and
+// testInter's bottomPixel is not strictly between the other two.
+//
+// The members are sorted by topPixel once. Walking from inter1 towards higher
+// topPixels, the intersections passed so far narrow a window of bottomPixels
+// (the highest seen below inter1's, the lowest seen above it); a partner is
+// unblocked exactly when its bottomPixel lies inside the window, and anything
+// outside it cannot narrow it further. A min/max tree over the bottomPixels
+// lets the walk jump to the next intersection inside the window, and the first
+// passed intersection without a bottomPixel ends it, as does inter1 running out
+// of ports. Blocked intersections are skipped by the tree instead of being
+// visited one by one, and no pair needs a between-check of its own.
+//
+// Pairs are offered nearest partner first, with inter1 in topPixel order. For
+// members listed in strip order (the way they are added) that is the order the
+// old all-pairs scan used, so port allocation is unchanged.
+
+struct ConnectionPlannerStats {
+  uint32_t visited = 0;
+  uint32_t offered = 0;
+};
+
+class ConnectionPlanner {
+ public:
+  // `hasPort(inter)` reports whether an intersection has a free port;
+  // `tryConnect(a, b)` creates the connection unless the pair is already
+  // connected.
+  template <typename Inter, typename HasPort, typename TryConnect>
+  void planGroup(std::vector<Inter*>& members, HasPort hasPort, TryConnect tryConnect) {
+    std::stable_sort(members.begin(), members.end(), [](const Inter* a, const Inter* b) {
+      return a->topPixel < b->topPixel;
+    });
+    const size_t count = members.size();
+    tops_.resize(count);
+    bottoms_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+      tops_[i] = members[i]->topPixel;
+      bottoms_[i] = members[i]->bottomPixel;
+    }
+    buildTree();
+
+    for (size_t i = 0; i < count; i++) {
+      Inter* inter1 = members[i];
+      if (!hasPort(inter1)) {
+        continue;
+      }
+      const int32_t bottom1 = bottoms_[i];
+      int32_t low = INT32_MIN;
+      int32_t high = INT32_MAX;
+
+      // Members sharing inter1's topPixel have nothing between them.
+      size_t next = i + 1;
+      for (; next < count && tops_[next] == tops_[i]; next++) {
+        if (stats) {
+          stats->visited++;
+        }
+        if (!offer(members, i, next, hasPort, tryConnect)) {
+          break;
+        }
+      }
+      const size_t firstAbove = next;
+
+      while (next < count && hasPort(inter1)) {
+        // Next member inside the window or without a bottomPixel; the ones
+        // skipped are blocked and cannot narrow the window.
+        size_t run = bottom1 == -1 ? next : std::min(firstWall(next), firstInWindow(next, low, high));
+        if (run >= count) {
+          break;
+        }
+        while (run > next && tops_[run - 1] == tops_[run]) {
+          run--;
+        }
+        const bool anyBetween = run > firstAbove;
+
+        // Members sharing a topPixel are not between each other, so the whole run
+        // is checked against the window before it narrows it.
+        size_t end = run;
+        bool wall = false;
+        for (; end < count && tops_[end] == tops_[run]; end++) {
+          const int32_t bottom2 = bottoms_[end];
+          bool blocked;
+          if (bottom1 == -1 || bottom2 == -1) {
+            wall = true;
+            blocked = anyBetween;
+          } else {
+            blocked = bottom2 < low || bottom2 > high;
+          }
+          if (stats) {
+            stats->visited++;
+          }
+          if (!blocked && hasPort(inter1)) {
+            offer(members, i, end, hasPort, tryConnect);
+          }
+        }
+        if (wall) {
+          break;
+        }
+        for (size_t k = run; k < end; k++) {
+          const int32_t bottom = bottoms_[k];
+          if (bottom < bottom1) {
+            low = std::max(low, bottom);
+          } else if (bottom > bottom1) {
+            high = std::min(high, bottom);
+          }
+        }
+        next = end;
+      }
+    }
+  }
+
+  ConnectionPlannerStats* stats = nullptr;
+
+ private:
+  template <typename Inter, typename HasPort, typename TryConnect>
+  bool offer(std::vector<Inter*>& members, size_t i, size_t j, HasPort& hasPort, TryConnect& tryConnect) {
+    if (hasPort(members[j])) {
+      if (stats) {
+        stats->offered++;
+      }
+      tryConnect(members[i], members[j]);
+    }
+    return hasPort(members[i]);
+  }
+
+  // Min/max of bottomPixel per node, ignoring -1, plus the next member without
+  // a bottomPixel from each position.
+  void buildTree() {
+    const size_t count = bottoms_.size();
+    size_ = 1;
+    while (size_ < count) {
+      size_ <<= 1;
+    }
+    min_.assign(2 * size_, INT32_MAX);
+    max_.assign(2 * size_, INT32_MIN);
+    for (size_t i = 0; i < count; i++) {
+      if (bottoms_[i] != -1) {
+        min_[size_ + i] = max_[size_ + i] = bottoms_[i];
+      }
+    }
+    for (size_t node = size_ - 1; node > 0; node--) {
+      min_[node] = std::min(min_[2 * node], min_[2 * node + 1]);
+      max_[node] = std::max(max_[2 * node], max_[2 * node + 1]);
+    }
+    walls_.assign(count + 1, count);
+    for (size_t i = count; i-- > 0;) {
+      walls_[i] = bottoms_[i] == -1 ? i : walls_[i + 1];
+    }
+  }
+
+  size_t firstWall(size_t from) const { return walls_[from]; }
+
+  // First position >= from whose bottomPixel lies in [low, high], or the member count.
+  size_t firstInWindow(size_t from, int32_t low, int32_t high) const {
+    const size_t found = search(1, 0, size_, from, low, high);
+    return std::min(found, bottoms_.size());
+  }
+
+  size_t search(size_t node, size_t begin, size_t end, size_t from, int32_t low, int32_t high) const {
+    if (end <= from || max_[node] < low || min_[node] > high) {
+      return SIZE_MAX;
+    }
+    if (end - begin == 1) {
+      return begin < bottoms_.size() && bottoms_[begin] != -1 ? begin : SIZE_MAX;
+    }
+    const size_t middle = (begin + end) / 2;
+    const size_t left = search(2 * node, begin, middle, from, low, high);
+    return left != SIZE_MAX ? left : search(2 * node + 1, middle, end, from, low, high);
+  }
+
+  std::vector<int32_t> tops_;
+  std::vector<int32_t> bottoms_;
+  std::vector<int32_t> min_;
+  std::vector<int32_t> max_;
+  std::vector<size_t> walls_;
+  size_t size_ = 1;
+};
@@ -6,7 +6,7 @@
 #include <esp_arduino_version.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/portmacro.h>
-#include <map>
+#include <new>
 #include <cstring>
 
 // Forward declarations
@@ -83,8 +83,42 @@ inline volatile uint8_t gESPNowRxCount = 0;
 inline volatile uint16_t gESPNowDroppedPackets = 0;
 inline portMUX_TYPE gESPNowQueueMux = portMUX_INITIALIZER_UNLOCKED;
 
-constexpr size_t MAX_REMOTE_LIGHT_LISTS = 24;
-inline std::map<uint16_t, LightList*> gRemoteLightLists;
+// Remote light lists are preallocated once at ESP-NOW init, so new remote ids
+// no longer allocate a LightList or std::map node each. Lights handed to the
+// graph keep pointing at their list, so a slot goes back on the free stack only
+// once every light received for it has outlived its life (plus a grace period
+// for fades); a new id arriving while every slot still has live lights is
+// rejected rather than recycling a list in use. Id lookup and the release sweep
+// are linear scans over the pool. Override the sizes from build flags.
+#ifndef ESPNOW_REMOTE_LIST_POOL_SIZE
+#define ESPNOW_REMOTE_LIST_POOL_SIZE 24
+#endif
+
+#ifndef ESPNOW_REMOTE_LIST_RELEASE_GRACE_MS
+#define ESPNOW_REMOTE_LIST_RELEASE_GRACE_MS 1000
+#endif
+
+constexpr size_t MAX_REMOTE_LIGHT_LISTS = ESPNOW_REMOTE_LIST_POOL_SIZE;
+static_assert(MAX_REMOTE_LIGHT_LISTS > 0 && MAX_REMOTE_LIGHT_LISTS <= 255,
+              "ESPNOW_REMOTE_LIST_POOL_SIZE must be in 1..255");
+
+struct RemoteLightListSlot {
+  LightList* list = nullptr;
+  uint16_t remoteListId = 0;
+  bool inUse = false;
+  // Set while any received light has an infinite life; such a list is never released.
+  bool pinned = false;
+  // gMillis by which every light received for this list has expired.
+  unsigned long liveUntil = 0;
+};
+
+inline RemoteLightListSlot gRemoteLightListPool[MAX_REMOTE_LIGHT_LISTS];
+inline uint8_t gRemoteLightListFreeSlots[MAX_REMOTE_LIGHT_LISTS];
+inline uint8_t gRemoteLightListFreeCount = 0;
+inline bool gRemoteLightListPoolReady = false;
+inline uint32_t gRemoteLightListAcquired = 0;
+inline uint32_t gRemoteLightListReleased = 0;
+inline uint32_t gRemoteLightListRejected = 0;
 
 inline void setESPNowLastError(const char* error) {
   if (error != nullptr && error[0] != '\0') {
@@ -260,23 +294,95 @@ inline bool ensurePeerForSend(const uint8_t* mac_addr) {
   return true;
 }
 
-inline LightList* getOrCreateRemoteLightList(uint16_t remoteListId) {
-  auto it = gRemoteLightLists.find(remoteListId);
-  if (it != gRemoteLightLists.end()) {
-    return it->second;
+inline bool initRemoteLightListPool() {
+  if (gRemoteLightListPoolReady) {
+    return true;
   }
 
-  if (gRemoteLightLists.size() >= MAX_REMOTE_LIGHT_LISTS) {
-    auto evict = gRemoteLightLists.begin();
-    if (evict->second != nullptr) {
-      delete evict->second;
+  gRemoteLightListFreeCount = 0;
+  for (size_t i = 0; i < MAX_REMOTE_LIGHT_LISTS; i++) {
+    RemoteLightListSlot& slot = gRemoteLightListPool[i];
+    if (slot.list == nullptr) {
+      slot.list = new (std::nothrow) LightList();
+      if (slot.list == nullptr) {
+        setESPNowLastError("remote_list_pool_alloc_failed");
+        continue;
+      }
     }
-    gRemoteLightLists.erase(evict);
+    slot.inUse = false;
+    slot.remoteListId = 0;
+    slot.pinned = false;
+    slot.liveUntil = 0;
+    gRemoteLightListFreeSlots[gRemoteLightListFreeCount++] = static_cast<uint8_t>(i);
   }
 
-  auto* created = new LightList();
-  gRemoteLightLists[remoteListId] = created;
-  return created;
+  gRemoteLightListPoolReady = gRemoteLightListFreeCount > 0;
+  return gRemoteLightListPoolReady;
+}
+
+inline uint8_t remoteLightListPoolInUse() {
+  return static_cast<uint8_t>(MAX_REMOTE_LIGHT_LISTS - gRemoteLightListFreeCount);
+}
+
+// Returns slots whose lights have all expired to the free stack.
+inline uint8_t releaseDrainedRemoteLightLists() {
+  uint8_t released = 0;
+  for (size_t i = 0; i < MAX_REMOTE_LIGHT_LISTS; i++) {
+    RemoteLightListSlot& slot = gRemoteLightListPool[i];
+    if (!slot.inUse || slot.pinned || static_cast<long>(gMillis - slot.liveUntil) < 0) {
+      continue;
+    }
+    slot.inUse = false;
+    gRemoteLightListFreeSlots[gRemoteLightListFreeCount++] = static_cast<uint8_t>(i);
+    gRemoteLightListReleased++;
+    released++;
+  }
+  return released;
+}
+
+inline RemoteLightListSlot* getOrCreateRemoteLightList(uint16_t remoteListId) {
+  for (size_t i = 0; i < MAX_REMOTE_LIGHT_LISTS; i++) {
+    RemoteLightListSlot& slot = gRemoteLightListPool[i];
+    if (slot.inUse && slot.remoteListId == remoteListId) {
+      return &slot;
+    }
+  }
+
+  if (!gRemoteLightListPoolReady && !initRemoteLightListPool()) {
+    gRemoteLightListRejected++;
+    return nullptr;
+  }
+
+  if (gRemoteLightListFreeCount == 0 && releaseDrainedRemoteLightLists() == 0) {
+    gRemoteLightListRejected++;
+    return nullptr;
+  }
+  RemoteLightListSlot* slot = &gRemoteLightListPool[gRemoteLightListFreeSlots[--gRemoteLightListFreeCount]];
+
+  // No light points at a released list any more, so it can be reconstructed in
+  // the pooled storage. The LightList itself is not freed, but its destructor
+  // and constructor may still release/allocate its internals.
+  slot->list->~LightList();
+  new (slot->list) LightList();
+  slot->remoteListId = remoteListId;
+  slot->inUse = true;
+  slot->pinned = false;
+  slot->liveUntil = gMillis;
+  gRemoteLightListAcquired++;
+  return slot;
+}
+
+// Extends the slot's release deadline to cover a light received with `life`
+// milliseconds left (the sender packs RuntimeLight::getLife()).
+inline void noteRemoteLightLife(RemoteLightListSlot& slot, uint32_t life) {
+  if (life >= static_cast<uint32_t>(INFINITE_DURATION)) {
+    slot.pinned = true;
+    return;
+  }
+  const unsigned long expiresAt = gMillis + life + ESPNOW_REMOTE_LIST_RELEASE_GRACE_MS;
+  if (static_cast<long>(expiresAt - slot.liveUntil) > 0) {
+    slot.liveUntil = expiresAt;
+  }
 }
 
 inline void handleReceivedLight(const LightMessage* lightMsg) {
@@ -290,17 +396,18 @@ inline void handleReceivedLight(const LightMessage* lightMsg) {
   }
   InternalPort* targetPort = static_cast<InternalPort*>(port);
 
-  LightList* lightList = getOrCreateRemoteLightList(lightMsg->listId);
-  if (lightList == nullptr) {
-    setESPNowLastError("remote_list_alloc_failed");
+  RemoteLightListSlot* slot = getOrCreateRemoteLightList(lightMsg->listId);
+  if (slot == nullptr) {
+    setESPNowLastError("remote_list_pool_exhausted");
     return;
   }
 
-  RuntimeLight* light = lightList->addLightFromMsg(lightMsg);
+  RuntimeLight* light = slot->list->addLightFromMsg(lightMsg);
   if (light == nullptr) {
     setESPNowLastError("remote_light_alloc_failed");
     return;
   }
+  noteRemoteLightLife(*slot, static_cast<uint32_t>(lightMsg->life));
 
   ColorRGB color;
   color.r = lightMsg->colorR;
@@ -309,6 +416,7 @@ inline void handleReceivedLight(const LightMessage* lightMsg) {
   light->setColor(color);
 
   targetPort->sendOut(light);
+  markOutputDirty();
 }
 
 inline void handleReceivedLightList(const LightListMessage* lightListMsg) {
@@ -359,6 +467,7 @@ inline void processQueuedESPNowPackets() {
       break;
     }
 
+    AllocScope allocScope(ALLOC_PHASE_ESPNOW);
     switch (packet.type) {
       case DISCOVERY_REQUEST:
         if (packet.len >= sizeof(DiscoveryRequest)) {
@@ -449,6 +558,8 @@ inline bool initESPNow() {
     return false;
   }
 
+  initRemoteLightListPool();
+
   esp_now_register_send_cb(onDataSent);
   esp_now_register_recv_cb(onDataReceived);
 
@@ -493,6 +604,7 @@ inline bool scanForPeers() {
 
 inline void tickESPNow() {
   processQueuedESPNowPackets();
+  releaseDrainedRemoteLightLists();
 
   if (discoveryActive && (millis() - discoveryStartTime > DISCOVERY_TIMEOUT_MS)) {
     discoveryActive = false;
@@ -63,7 +63,19 @@ void loadSettings() {
   pixelCount2 = doc["pixel_count2"] | pixelCount2;
   pixelPin1 = doc["pixel_pin1"] | pixelPin1;
   pixelPin2 = doc["pixel_pin2"] | pixelPin2;
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    OutputStripConfig& output = outputs[i];
+    const String suffix = String(i + 1);
+    if (i >= 2) {
+      output.pixelCount = doc["pixel_count" + suffix] | output.pixelCount;
+      output.pin = doc["pixel_pin" + suffix] | output.pin;
+    }
+    output.ledType = doc["led_type" + suffix] | output.ledType;
+    output.colorOrder = doc["color_order" + suffix] | output.colorOrder;
+  }
   pixelDensity = doc["pixel_density"] | pixelDensity;
+  outputRefreshMs = doc["output_refresh_ms"] | outputRefreshMs;
+  simTickHz = doc["sim_tick_hz"] | simTickHz;
   ledType = doc["led_type"] | ledType;
   colorOrder = doc["color_order"] | colorOrder;
   ledLibrary = doc["led_library"] | ledLibrary;
@@ -110,146 +122,6 @@ void loadSettings() {
   LP_LOGLN("Settings loaded from SPIFFS using ArduinoJson");
 }
 
-// Helper function to process layers array data
-void processLayersArray(JsonArray& layersArray) {
-  for (JsonObject layerObj : layersArray) {
-    if (!layerObj.containsKey("index")) continue;
-
-    uint8_t index = layerObj["index"].as<uint8_t>();
-    if (index >= MAX_LIGHT_LISTS) continue;
-    if (!state->lightLists[index]) {
-      state->setupBg(index);
-    }
-
-    // Set visibility
-    if (layerObj.containsKey("visible")) {
-      state->lightLists[index]->visible = layerObj["visible"].as<bool>();
-    }
-
-    // Set brightness
-    if (layerObj.containsKey("brightness")) {
-      uint8_t brightness = layerObj["brightness"].as<uint8_t>();
-      state->lightLists[index]->maxBri = brightness;
-      if (state->lightLists[index]->minBri > brightness) {
-        state->lightLists[index]->minBri = brightness;
-      }
-    }
-    
-    // Set blend mode
-    if (layerObj.containsKey("blendMode")) {
-      uint8_t blendMode = layerObj["blendMode"].as<uint8_t>();
-      if (blendMode <= BLEND_PIN_LIGHT) {
-        state->lightLists[index]->blendMode = static_cast<BlendMode>(blendMode);
-      }
-    }
-    
-    // Set speed
-    if (layerObj.containsKey("speed")) {
-      float speed = layerObj["speed"].as<float>();
-      if (speed >= -10.0f && speed <= 10.0f) {
-        // Save the current speed, will apply with the ease function
-        state->lightLists[index]->speed = speed;
-      }
-    }
-    
-    // Set ease function
-    if (layerObj.containsKey("ease")) {
-      uint8_t ease = layerObj["ease"].as<uint8_t>();
-      if (ease <= EASE_ELASTIC_INOUT) {
-        // Use the setSpeed function to set both speed and ease
-        float currentSpeed = state->lightLists[index]->speed;
-        state->lightLists[index]->setSpeed(currentSpeed, ease);
-      }
-    }
-    
-    // Set fade speed
-    if (layerObj.containsKey("fadeSpeed")) {
-      uint8_t fadeSpeed = layerObj["fadeSpeed"].as<uint8_t>();
-      uint8_t currentFadeThresh = state->lightLists[index]->fadeThresh;
-      uint8_t currentFadeEase = state->lightLists[index]->fadeEaseIndex;
-      state->lightLists[index]->setFade(fadeSpeed, currentFadeThresh, currentFadeEase);
-    }
-    
-    // Set behaviour flags
-    if (layerObj.containsKey("behaviourFlags")) {
-      uint16_t behaviourFlags = layerObj["behaviourFlags"].as<uint16_t>();
-      
-      // Check if behaviour object exists
-      if (!state->lightLists[index]->behaviour) {
-        // Create a new behaviour object with the specified flags
-        state->lightLists[index]->behaviour = new Behaviour(behaviourFlags);
-      } else {
-        // Update existing behaviour flags
-        state->lightLists[index]->behaviour->flags = behaviourFlags;
-      }
-    }
-
-    // Set offset
-    if (layerObj.containsKey("offset")) {
-      float offset = layerObj["offset"].as<float>();
-      state->lightLists[index]->setOffset(offset);
-    }
-
-    // Set palette for this layer
-    if (layerObj.containsKey("colors") && layerObj["colors"].is<JsonArray>()) {
-      std::vector<int64_t> layerColors;
-      std::vector<float> layerPositions;
-
-      // Load colors
-      JsonArray colorsArray = layerObj["colors"].as<JsonArray>();
-      for (JsonVariant color : colorsArray) {
-        layerColors.push_back(color.as<int64_t>());
-      }
-
-      // Load positions
-      if (layerObj.containsKey("positions") && layerObj["positions"].is<JsonArray>()) {
-        JsonArray positionsArray = layerObj["positions"].as<JsonArray>();
-        for (JsonVariant pos : positionsArray) {
-          layerPositions.push_back(pos.as<float>());
-        }
-      }
-
-      // Ensure positions match colors
-      if (layerPositions.size() != layerColors.size()) {
-        layerPositions.clear();
-        for (size_t i = 0; i < layerColors.size(); i++) {
-          float pos = (layerColors.size() == 1) ? 0.0f :
-                    static_cast<float>(i) / static_cast<float>(layerColors.size() - 1);
-          layerPositions.push_back(pos);
-        }
-      }
-
-      // Create palette
-      if (layerColors.size() > 0) {
-        Palette palette(layerColors, layerPositions);
-
-        // Set color rule
-        if (layerObj.containsKey("colorRule")) {
-          palette.setColorRule(layerObj["colorRule"].as<int8_t>());
-        }
-
-        // Set interpolation mode
-        if (layerObj.containsKey("interMode")) {
-          palette.setInterMode(layerObj["interMode"].as<int8_t>());
-        }
-
-        // Set wrap mode
-        if (layerObj.containsKey("wrapMode")) {
-          palette.setWrapMode(layerObj["wrapMode"].as<int8_t>());
-        }
-
-        // Set segmentation
-        if (layerObj.containsKey("segmentation")) {
-          palette.setSegmentation(layerObj["segmentation"].as<float>());
-        }
-
-        // Set the palette on the light list
-        state->lightLists[index]->setPalette(palette);
-      }
-    }
-  }
-}
-
 void loadLayers() {
   // First try to load from dedicated layers.json file
   if (SPIFFS.exists("/layers.json")) {
@@ -291,6 +163,8 @@ void saveSettings() {
   // The rule of thumb: reserve 10 bytes per element + string lengths for object keys and values
   const size_t capacity = JSON_OBJECT_SIZE(30) +
                           JSON_ARRAY_SIZE(8) + // For bg_colors array (assuming max 8 colors)
+                          JSON_OBJECT_SIZE(OUTPUT_MAX_STRIPS * 4) + // For pixel_countN/pixel_pinN/led_typeN/color_orderN
+                          OUTPUT_MAX_STRIPS * 4 * 16 + // Copies of those generated keys
                           JSON_ARRAY_SIZE(MAX_LIGHT_LISTS) + // For layers array
                           MAX_LIGHT_LISTS * JSON_OBJECT_SIZE(10) + // For each layer object
                           MAX_LIGHT_LISTS * JSON_ARRAY_SIZE(8) * 2 + // For colors and positions arrays per layer
@@ -309,7 +183,24 @@ void saveSettings() {
   doc["pixel_count2"] = pixelCount2;
   doc["pixel_pin1"] = pixelPin1;
   doc["pixel_pin2"] = pixelPin2;
+  // Extra strips and per-strip overrides are only written when set.
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    const OutputStripConfig& output = outputs[i];
+    const String suffix = String(i + 1);
+    if (i >= 2 && output.pixelCount > 0) {
+      doc["pixel_count" + suffix] = output.pixelCount;
+      doc["pixel_pin" + suffix] = output.pin;
+    }
+    if (output.ledType != OUTPUT_INHERIT) {
+      doc["led_type" + suffix] = output.ledType;
+    }
+    if (output.colorOrder != OUTPUT_INHERIT) {
+      doc["color_order" + suffix] = output.colorOrder;
+    }
+  }
   doc["pixel_density"] = pixelDensity;
+  doc["output_refresh_ms"] = outputRefreshMs;
+  doc["sim_tick_hz"] = simTickHz;
   doc["led_type"] = ledType;
   doc["color_order"] = colorOrder;
   doc["led_library"] = ledLibrary;
@@ -413,10 +304,9 @@ void loadUserPalettes() {
             colorStr = colorStr.substring(1);
           }
           // Convert hex string to integer
-          int64_t color = strtol(colorStr.c_str(), NULL, 16);
-          palette.colors.push_back(color);
+          palette.colors.push_back(static_cast<uint32_t>(strtoul(colorStr.c_str(), NULL, 16)));
         } else if (colorVar.is<int>() || colorVar.is<int64_t>()) {
-          palette.colors.push_back(colorVar.as<int64_t>());
+          palette.colors.push_back(static_cast<uint32_t>(colorVar.as<int64_t>()));
         }
       }
     }
@@ -426,19 +316,14 @@ void loadUserPalettes() {
       JsonArray posArray = paletteObj["positions"].as<JsonArray>();
       for (JsonVariant posVar : posArray) {
         if (posVar.is<float>()) {
-          palette.positions.push_back(posVar.as<float>());
+          palette.positions.push_back(encodePalettePosition(posVar.as<float>()));
         }
       }
     }
 
     // If positions don't match colors, generate default positions
     if (palette.positions.size() != palette.colors.size()) {
-      palette.positions.clear();
-      for (size_t i = 0; i < palette.colors.size(); i++) {
-        float pos = (palette.colors.size() == 1) ? 0.0f :
-                    static_cast<float>(i) / static_cast<float>(palette.colors.size() - 1);
-        palette.positions.push_back(pos);
-      }
+      palette.fillDefaultPositions();
     }
 
     // Load palette properties
@@ -493,7 +378,7 @@ bool saveUserPalettes(const std::vector<UserPalette>& palettes) {
     // Add positions array
     JsonArray positionsArray = paletteObj.createNestedArray("positions");
     for (const auto& pos : p.positions) {
-      positionsArray.add(pos);
+      positionsArray.add(decodePalettePosition(pos));
     }
   }
 
@@ -623,80 +508,16 @@ void saveCredentials() {
   LP_LOGLN("Credentials saved to NVS");
 }
 
+// Only editable lists are written (see serializeLayers()). Emitted lists still in
+// flight used to be saved as well, and loadLayers() then brought them back as
+// background layers on the next boot.
 void saveLayers() {
-  // Calculate capacity for JsonDocument with support for multiple light lists
-  const size_t capacity = JSON_OBJECT_SIZE(1) + // For root object with layers array
-                         JSON_ARRAY_SIZE(MAX_LIGHT_LISTS) + // For layers array
-                         MAX_LIGHT_LISTS * JSON_OBJECT_SIZE(10) + // For each layer object
-                         MAX_LIGHT_LISTS * JSON_ARRAY_SIZE(8) * 2 + // For colors and positions arrays per layer
-                         1024; // Extra space for values
-
-  DynamicJsonDocument layersDoc(capacity);
+  DynamicJsonDocument layersDoc(layersDocCapacity());
   
   // Save light lists as layers
   if (state) {
     JsonArray layersArray = layersDoc.createNestedArray("layers");
-
-    // Save each editable light list
-    for (uint8_t i = 0; i < MAX_LIGHT_LISTS; i++) {
-      if (state->lightLists[i]) {
-        JsonObject layerObj = layersArray.createNestedObject();
-
-        // Save layer index
-        layerObj["index"] = i;
-
-        // Save visibility
-        layerObj["visible"] = state->lightLists[i]->visible;
-
-        // Save brightness
-        layerObj["brightness"] = state->lightLists[i]->maxBri;
-        
-        // Save blend mode
-        layerObj["blendMode"] = static_cast<uint8_t>(state->lightLists[i]->blendMode);
-        
-        // Save speed
-        layerObj["speed"] = state->lightLists[i]->speed;
-        
-        // Use the stored easeIndex
-        layerObj["ease"] = state->lightLists[i]->easeIndex;
-        
-        // Save fade speed
-        layerObj["fadeSpeed"] = state->lightLists[i]->fadeSpeed;
-        
-        // Save offset
-        layerObj["offset"] = state->lightLists[i]->getOffset();
-        
-        // Save behaviour flags
-        if (state->lightLists[i]->behaviour) {
-          layerObj["behaviourFlags"] = state->lightLists[i]->behaviour->flags;
-        }
-
-        // Save palette if available
-        if (state->lightLists[i]->hasPalette()) {
-          const Palette& palette = state->lightLists[i]->getPalette();
-
-          // Save palette colors
-          JsonArray colorsArray = layerObj.createNestedArray("colors");
-          const std::vector<int64_t>& colors = palette.getColors();
-          for (const auto& color : colors) {
-            colorsArray.add(color);
-          }
-
-          // Save palette positions
-          JsonArray positionsArray = layerObj.createNestedArray("positions");
-          const std::vector<float>& positions = palette.getPositions();
-          for (const auto& pos : positions) {
-            positionsArray.add(pos);
-          }
-
-          // Save palette properties
-          layerObj["colorRule"] = palette.getColorRule();
-          layerObj["interMode"] = palette.getInterMode();
-          layerObj["wrapMode"] = palette.getWrapMode();
-          layerObj["segmentation"] = palette.getSegmentation();
-        }
-      }
-    }
+    serializeLayers(layersArray);
   }
   
   // Open the file for writing
@@ -765,7 +586,7 @@ bool deletePalette(size_t index) {
     // Add positions array
     JsonArray positionsArray = paletteObj.createNestedArray("positions");
     for (const auto& pos : p.positions) {
-      positionsArray.add(pos);
+      positionsArray.add(decodePalettePosition(pos));
     }
   }
 
@@ -105,7 +105,7 @@
 
 #define FASTLED_ADD_CHIPSET(CHIPSET, LEDS, COUNT, PIN, COLOR_ORDER) \
   do {                                                               \
-    if (IS_RGB(COLOR_ORDER)) {                                       \
+    if (IS_RGB(COLOR_ORDER) || (COLOR_ORDER) == CO_RGBW) {           \
       FASTLED_ADD_CHIPSET_FOR_ORDER(CHIPSET, RGB, LEDS, COUNT, PIN, COLOR_ORDER); \
     } else {                                                         \
       FASTLED_ADD_CHIPSET_FOR_ORDER(CHIPSET, GRB, LEDS, COUNT, PIN, COLOR_ORDER); \
@@ -147,28 +147,18 @@ const char* fastLedTypeName(uint8_t ledType) {
 }
 
 void setupFastLED() {
-  if (leds1 != NULL) {
-    delete[] leds1;
-    leds1 = NULL;
-  }
-  if (leds2 != NULL) {
-    delete[] leds2;
-    leds2 = NULL;
+  if (leds != NULL) {
+    delete[] leds;
+    leds = NULL;
   }
 
   if (ledLibrary != LIB_FASTLED) return;
 
-  if (pixelCount1 > 0) {
-    leds1 = new CRGB[pixelCount1];
-  }
-  if (pixelCount2 > 0) {
-    leds2 = new CRGB[pixelCount2];
-  }
-
-  if (leds1 == NULL) {
-    LP_LOGLN("FastLED setup skipped: pixelCount1 must be > 0");
+  if (outputMap.stripCount == 0) {
+    LP_LOGLN("FastLED setup skipped: no strip has pixelCount > 0");
     return;
   }
+  leds = new CRGB[outputMap.totalPixels];
 
   // Helper function to add LEDs with the right chipset and color order.
   auto addLedsWithConfig = [](CRGB* leds, uint16_t count, uint8_t pin, uint8_t ledType, uint8_t colorOrder) {
@@ -207,19 +197,17 @@ void setupFastLED() {
     }
   };
 
-  // Initialize strip 1
-  addLedsWithConfig(leds1, pixelCount1, pixelPin1, ledType, colorOrder);
-
-  // Initialize strip 2 if needed
-  if (pixelCount2 > 0) {
-    addLedsWithConfig(leds2, pixelCount2, pixelPin2, ledType, colorOrder);
+  // Each strip is a controller over its own span of the shared buffer.
+  for (uint8_t i = 0; i < outputMap.stripCount; i++) {
+    const OutputStrip& output = outputMap.strips[i];
+    addLedsWithConfig(leds + output.start, output.count, output.pin, output.ledType, output.colorOrder);
   }
 
   FastLED.setBrightness(maxBrightness);
   FastLED.clear();
   FastLED.show();
 
-  LP_LOGLN("FastLED initialized with ledType = " + String(fastLedTypeName(ledType)) +
+  LP_LOGLN("FastLED initialized with " + String(outputMap.stripCount) + " strip(s), ledType = " + String(fastLedTypeName(ledType)) +
            ", colorOrder = " + String(IS_RGB(colorOrder) ? "RGB" : "GRB"));
 }
 
@@ -230,34 +218,32 @@ CRGB getFastLEDColor(uint16_t i) {
 
   #ifdef DEBUGGER_ENABLED
   if (state->showConnections) {
-    color.g = (debugger->isConnection(i) ? 1.f : 0.f) * effectiveBrightness;
+    color.g = debugger->isConnection(i) ? effectiveBrightness : 0;
   }
   if (state->showIntersections) {
-    color.b = (debugger->isIntersection(i) ? 1.f : 0.f) * effectiveBrightness;
+    color.b = debugger->isIntersection(i) ? effectiveBrightness : 0;
   }
   #endif
   return color;
 }
 
-float getFastLEDWatts(const CRGB& color, float wattsPerLed = 0.2f) {
-  const float relPixelPower = static_cast<float>(color.r + color.g + color.b) / (255.f * 3.f);
-  const float wattsPerPixel = wattsPerLed * 3.f;
-  return relPixelPower * wattsPerPixel;
+uint16_t getFastLEDChannelSum(const CRGB& color) {
+  return color.r + color.g + color.b;
 }
 
 void drawFastLED() {
-  if (ledLibrary == LIB_FASTLED && leds1 != NULL) {
+  if (ledLibrary == LIB_FASTLED && leds != NULL) {
     const uint8_t effectiveBrightness = wledMasterOn ? maxBrightness : 0;
-    totalWattage = 0.0f;
-    for (uint16_t i=0; i<pixelCount1; i++) {
-      leds1[i] = getFastLEDColor(i);
-      totalWattage += getFastLEDWatts(leds1[i]);
+    uint32_t channelSum = 0;
+    for (uint16_t i=0; i<outputMap.totalPixels; i++) {
+      leds[i] = getFastLEDColor(i);
+      channelSum += getFastLEDChannelSum(leds[i]);
+      outputFrameHashPixel(leds[i].r, leds[i].g, leds[i].b);
     }
-    if (pixelCount2 > 0 && leds2 != NULL) {
-      for (uint16_t i=0; i<pixelCount2; i++) {
-        leds2[i] = getFastLEDColor(pixelCount1+i);
-        totalWattage += getFastLEDWatts(leds2[i]);
-      }
+    totalWattage = outputWattsFromChannelSum(channelSum);
+    // Identical frames keep the previous wire data unless a refresh is due.
+    if (!commitOutputFrame(outputRefreshMs)) {
+      return;
     }
     FastLED.setBrightness(effectiveBrightness);
     FastLED.show();
@@ -7,6 +7,7 @@
 #include <WString.h>
 
 #include "LightGraph.h"
+#include "OutputMap.h"
 
 #ifndef DEFAULT_HOSTNAME
 #define DEFAULT_HOSTNAME "meshled"
@@ -16,14 +17,41 @@
 class Debugger;
 #endif
 
+// Palette stop positions are stored as unsigned 0.16 fixed point (0 = 0.0,
+// PALETTE_POSITION_ONE = 1.0); JSON keeps exposing them as floats.
+constexpr uint16_t PALETTE_POSITION_ONE = 0xFFFF;
+
+inline uint16_t encodePalettePosition(float position) {
+  if (!(position > 0.0f)) {
+    return 0;
+  }
+  if (position >= 1.0f) {
+    return PALETTE_POSITION_ONE;
+  }
+  return static_cast<uint16_t>(position * PALETTE_POSITION_ONE + 0.5f);
+}
+
+inline float decodePalettePosition(uint16_t position) {
+  return static_cast<float>(position) / PALETTE_POSITION_ONE;
+}
+
 struct UserPalette {
   String name;
-  std::vector<int64_t> colors;
-  std::vector<float> positions;
+  std::vector<uint32_t> colors;   // packed 0xRRGGBB
+  std::vector<uint16_t> positions;
   int8_t colorRule = -1;
   int8_t interMode = 1;
   int8_t wrapMode = 0;
   float segmentation = 0.0f;
+
+  void fillDefaultPositions() {
+    positions.clear();
+    positions.reserve(colors.size());
+    for (size_t i = 0; i < colors.size(); i++) {
+      positions.push_back(colors.size() == 1 ? 0 :
+                          static_cast<uint16_t>((i * PALETTE_POSITION_ONE) / (colors.size() - 1)));
+    }
+  }
 };
 
 struct FirmwareContext {
@@ -39,15 +67,18 @@ struct FirmwareContext {
   uint8_t ledType = LED_WS2812;
 #if defined(FASTLED_ENABLED) && !defined(NEOPIXELBUS_ENABLED)
   uint8_t ledLibrary = LIB_FASTLED;
+#elif defined(VIRTUAL_LEDS_ENABLED) && !defined(NEOPIXELBUS_ENABLED)
+  uint8_t ledLibrary = LIB_VIRTUAL;
 #else
   uint8_t ledLibrary = LIB_NEOPIXELBUS;
 #endif
   uint8_t colorOrder = CO_GRB;
-  uint16_t pixelCount1 = 300;
-  uint16_t pixelCount2 = 0;
-  uint8_t pixelPin1 = 14;
-  uint8_t pixelPin2 = 26;
+  // Strip 1 and 2 keep their pixel_count1/pixel_pin1 names; see OutputMap.h.
+  OutputStripConfig outputs[OUTPUT_MAX_STRIPS] = {{300, 14}, {0, 26}};
+  OutputMap outputMap;
   uint8_t pixelDensity = 60;
+  uint16_t outputRefreshMs = 1000;
+  uint16_t simTickHz = 0;
   bool oscEnabled = true;
   uint16_t oscPort = 54321;
   bool otaEnabled = true;
@@ -67,7 +98,8 @@ struct FirmwareContext {
   uint8_t emitterMaxVal = 255;
   uint16_t emitterMinNext = 2000;
   uint16_t emitterMaxNext = 20000;
-  int16_t emitterFrom = -1;
+  // -1 for a random start, otherwise an intersection id.
+  int emitterFrom = -1;
 
   TopologyObject* object = nullptr;
   uint8_t objectType = OBJ_LINE;
@@ -0,0 +1,556 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+
+// Incremental JSON reader for request bodies. Bytes are pushed in as they arrive
+// (see streamRawJsonBody) and each scalar is handed to a JsonStreamSink together
+// with its path, so handlers keep only the typed values they need instead of the
+// body String plus a JsonDocument sized from it. Working memory is fixed: one
+// token buffer and one frame per nesting level.
+//
+// Paths are written as member keys joined by '.', with "[]" for array elements:
+// "intersections[].id", "models[].weights[].conditionals[]", "[].colors[]".
+//
+// Keys longer than JSON_STREAM_MAX_KEY and strings or numbers longer than
+// JSON_STREAM_MAX_TOKEN do not fail the read, so unknown or ignored fields can be
+// any size: a long key never matches a path, and a long value reaches the sink
+// cut to JSON_STREAM_MAX_TOKEN bytes with `truncated` set. Sinks that use such
+// a value reject it themselves.
+
+#ifndef JSON_STREAM_MAX_DEPTH
+#define JSON_STREAM_MAX_DEPTH 8
+#endif
+
+#ifndef JSON_STREAM_MAX_KEY
+#define JSON_STREAM_MAX_KEY 24
+#endif
+
+#ifndef JSON_STREAM_MAX_TOKEN
+#define JSON_STREAM_MAX_TOKEN 128
+#endif
+
+struct JsonStreamFrame {
+  bool isArray = false;
+  // Set when the member key did not fit `key`; the member then matches no path.
+  bool keyTooLong = false;
+  uint16_t index = 0;
+  char key[JSON_STREAM_MAX_KEY] = {};
+};
+
+class JsonStreamPath {
+ public:
+  uint8_t depth() const { return depth_; }
+
+  // Key of the innermost object member, or "" inside an array or for a key that
+  // was too long to keep.
+  const char* key() const {
+    if (depth_ == 0 || frames_[depth_ - 1].isArray || frames_[depth_ - 1].keyTooLong) {
+      return "";
+    }
+    return frames_[depth_ - 1].key;
+  }
+
+  uint16_t index() const {
+    return depth_ > 0 && frames_[depth_ - 1].isArray ? frames_[depth_ - 1].index : 0;
+  }
+
+  bool is(const char* pattern) const { return matches(pattern, depth_); }
+
+  // True when the path without its last member matches `pattern`, e.g. a value at
+  // "intersections[].id" is inside "intersections[]".
+  bool parentIs(const char* pattern) const { return depth_ > 0 && matches(pattern, depth_ - 1); }
+
+ protected:
+  bool matches(const char* pattern, uint8_t levels) const {
+    for (uint8_t i = 0; i < levels; i++) {
+      const JsonStreamFrame& frame = frames_[i];
+      if (frame.isArray) {
+        if (pattern[0] != '[' || pattern[1] != ']') {
+          return false;
+        }
+        pattern += 2;
+        continue;
+      }
+      if (frame.keyTooLong) {
+        return false;
+      }
+      if (i > 0) {
+        if (*pattern != '.') {
+          return false;
+        }
+        pattern++;
+      }
+      const size_t length = strlen(frame.key);
+      if (strncmp(pattern, frame.key, length) != 0) {
+        return false;
+      }
+      pattern += length;
+    }
+    return *pattern == '\0';
+  }
+
+  JsonStreamFrame frames_[JSON_STREAM_MAX_DEPTH];
+  uint8_t depth_ = 0;
+};
+
+struct JsonStreamValue {
+  enum Type : uint8_t { Text, Number, Bool, Null };
+
+  Type type = Null;
+  const char* text = "";
+  bool boolean = false;
+  // Text or Number longer than JSON_STREAM_MAX_TOKEN; `text` holds its first bytes.
+  bool truncated = false;
+
+  bool isNull() const { return type == Null; }
+
+  // Integer in [minValue, maxValue]; fractional and non-numeric values fail.
+  bool toLong(long minValue, long maxValue, long& out) const {
+    if (type != Number || truncated) {
+      return false;
+    }
+    errno = 0;
+    char* end = nullptr;
+    const long parsed = strtol(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || parsed < minValue || parsed > maxValue) {
+      return false;
+    }
+    out = parsed;
+    return true;
+  }
+
+  // Out-of-range numbers (1e999) give `fallback` rather than infinity.
+  float toFloat(float fallback = 0.0f) const {
+    if (type != Number || truncated) {
+      return fallback;
+    }
+    const float parsed = strtof(text, nullptr);
+    return std::isfinite(parsed) ? parsed : fallback;
+  }
+
+  bool toBool() const {
+    if (type == Bool) {
+      return boolean;
+    }
+    return toFloat() != 0.0f;
+  }
+};
+
+class JsonStreamSink {
+ public:
+  virtual ~JsonStreamSink() = default;
+
+  // Clears whatever a previous request left behind.
+  virtual void reset() {}
+
+  // Return false to stop reading; the sink keeps its own error message.
+  virtual bool onValue(const JsonStreamPath& path, const JsonStreamValue& value) = 0;
+  // `path` is the container's own path ("models[]" for each model object).
+  virtual bool onContainerStart(const JsonStreamPath&, bool /*isArray*/) { return true; }
+  virtual bool onContainerEnd(const JsonStreamPath&, bool /*isArray*/) { return true; }
+  virtual bool onDocumentEnd() { return true; }
+};
+
+class JsonStreamReader : public JsonStreamPath {
+ public:
+  void begin(JsonStreamSink* sink, size_t maxBytes) {
+    sink_ = sink;
+    maxBytes_ = maxBytes;
+    received_ = 0;
+    depth_ = 0;
+    expect_ = Expect::Value;
+    lex_ = Lex::None;
+    tokenLength_ = 0;
+    tokenTruncated_ = false;
+    error_ = nullptr;
+    sinkRejected_ = false;
+    tooLarge_ = false;
+    finished_ = false;
+  }
+
+  bool feed(const uint8_t* data, size_t length) {
+    if (failed() || sink_ == nullptr) {
+      return false;
+    }
+    received_ += length;
+    if (maxBytes_ > 0 && received_ > maxBytes_) {
+      tooLarge_ = true;
+      return fail("JSON body too large");
+    }
+    for (size_t i = 0; i < length; i++) {
+      if (!consume(static_cast<char>(data[i]))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool feed(const char* text, size_t length) {
+    return feed(reinterpret_cast<const uint8_t*>(text), length);
+  }
+
+  // Call once the whole body has been fed.
+  bool finish() {
+    if (finished_ || failed()) {
+      return finished_;
+    }
+    if (lex_ == Lex::Literal && !endLiteral()) {
+      return false;
+    }
+    if (lex_ != Lex::None || expect_ != Expect::Done) {
+      return fail("Invalid JSON");
+    }
+    if (!sink_->onDocumentEnd()) {
+      sinkRejected_ = true;
+      return fail("Invalid JSON");
+    }
+    finished_ = true;
+    return true;
+  }
+
+  JsonStreamSink* sink() const { return sink_; }
+  bool finished() const { return finished_; }
+  bool failed() const { return error_ != nullptr; }
+  // Set when the sink stopped the read; report the sink's own error instead.
+  bool sinkRejected() const { return sinkRejected_; }
+  bool tooLarge() const { return tooLarge_; }
+  size_t received() const { return received_; }
+  const char* error() const { return error_ != nullptr ? error_ : ""; }
+
+ private:
+  enum class Expect : uint8_t { Value, FirstValueOrEnd, Key, FirstKeyOrEnd, Colon, CommaOrEnd, Done };
+  enum class Lex : uint8_t { None, Text, Escape, Unicode, Literal };
+  // Position in the JSON number grammar: -? (0 | [1-9][0-9]*) (. [0-9]+)? ([eE] [+-]? [0-9]+)?
+  enum class Num : uint8_t { Sign, Zero, Int, Dot, Frac, Exp, ExpSign, ExpDigits, Keyword };
+
+  bool fail(const char* message) {
+    if (error_ == nullptr) {
+      error_ = message;
+    }
+    return false;
+  }
+
+  static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+  static bool isLiteralChar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '-' || c == '+' || c == '.';
+  }
+
+  static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+  // Bytes past JSON_STREAM_MAX_TOKEN are dropped and the token is marked truncated.
+  bool pushToken(char c) {
+    if (tokenLength_ >= JSON_STREAM_MAX_TOKEN) {
+      tokenTruncated_ = true;
+      return true;
+    }
+    token_[tokenLength_++] = c;
+    return true;
+  }
+
+  // Checks each literal character as it arrives, so the grammar holds even for
+  // numbers too long to keep.
+  bool advanceLiteral(char c) {
+    switch (num_) {
+      case Num::Sign:
+        num_ = c == '0' ? Num::Zero : Num::Int;
+        return isDigit(c);
+      case Num::Zero:
+      case Num::Int:
+        if (isDigit(c)) {
+          return num_ == Num::Int;
+        }
+        if (c == '.') {
+          num_ = Num::Dot;
+          return true;
+        }
+        if (c == 'e' || c == 'E') {
+          num_ = Num::Exp;
+          return true;
+        }
+        return false;
+      case Num::Dot:
+        num_ = Num::Frac;
+        return isDigit(c);
+      case Num::Frac:
+        if (isDigit(c)) {
+          return true;
+        }
+        if (c == 'e' || c == 'E') {
+          num_ = Num::Exp;
+          return true;
+        }
+        return false;
+      case Num::Exp:
+        if (c == '+' || c == '-') {
+          num_ = Num::ExpSign;
+          return true;
+        }
+        num_ = Num::ExpDigits;
+        return isDigit(c);
+      case Num::ExpSign:
+        num_ = Num::ExpDigits;
+        return isDigit(c);
+      case Num::ExpDigits:
+        return isDigit(c);
+      case Num::Keyword:
+        return tokenLength_ < 5;
+    }
+    return false;
+  }
+
+  bool startLiteral(char c) {
+    lex_ = Lex::Literal;
+    if (c == '-') {
+      num_ = Num::Sign;
+    } else if (isDigit(c)) {
+      num_ = c == '0' ? Num::Zero : Num::Int;
+    } else {
+      num_ = Num::Keyword;
+    }
+    return pushToken(c);
+  }
+
+  bool pushUtf8(uint16_t codepoint) {
+    if (codepoint < 0x80) {
+      return pushToken(static_cast<char>(codepoint));
+    }
+    if (codepoint < 0x800) {
+      return pushToken(static_cast<char>(0xC0 | (codepoint >> 6))) &&
+             pushToken(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+    return pushToken(static_cast<char>(0xE0 | (codepoint >> 12))) &&
+           pushToken(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F))) &&
+           pushToken(static_cast<char>(0x80 | (codepoint & 0x3F)));
+  }
+
+  bool emit(const JsonStreamValue& value) {
+    if (!sink_->onValue(*this, value)) {
+      sinkRejected_ = true;
+      return fail("Invalid JSON");
+    }
+    afterValue();
+    return true;
+  }
+
+  void afterValue() { expect_ = depth_ == 0 ? Expect::Done : Expect::CommaOrEnd; }
+
+  bool beginContainer(bool isArray) {
+    if (!sink_->onContainerStart(*this, isArray)) {
+      sinkRejected_ = true;
+      return fail("Invalid JSON");
+    }
+    if (depth_ >= JSON_STREAM_MAX_DEPTH) {
+      return fail("JSON nested too deeply");
+    }
+    JsonStreamFrame& frame = frames_[depth_++];
+    frame.isArray = isArray;
+    frame.index = 0;
+    frame.keyTooLong = false;
+    frame.key[0] = '\0';
+    expect_ = isArray ? Expect::FirstValueOrEnd : Expect::FirstKeyOrEnd;
+    return true;
+  }
+
+  bool endContainer(bool isArray) {
+    depth_--;
+    if (!sink_->onContainerEnd(*this, isArray)) {
+      sinkRejected_ = true;
+      return fail("Invalid JSON");
+    }
+    afterValue();
+    return true;
+  }
+
+  bool endString() {
+    token_[tokenLength_] = '\0';
+    lex_ = Lex::None;
+    if (stringIsKey_) {
+      JsonStreamFrame& frame = frames_[depth_ - 1];
+      frame.keyTooLong = tokenTruncated_ || tokenLength_ >= JSON_STREAM_MAX_KEY;
+      if (frame.keyTooLong) {
+        frame.key[0] = '\0';
+      } else {
+        memcpy(frame.key, token_, tokenLength_ + 1);
+      }
+      expect_ = Expect::Colon;
+      return true;
+    }
+    JsonStreamValue value;
+    value.type = JsonStreamValue::Text;
+    value.text = token_;
+    value.truncated = tokenTruncated_;
+    return emit(value);
+  }
+
+  bool endLiteral() {
+    token_[tokenLength_] = '\0';
+    lex_ = Lex::None;
+    JsonStreamValue value;
+    value.text = token_;
+    if (num_ == Num::Keyword) {
+      if (strcmp(token_, "true") == 0 || strcmp(token_, "false") == 0) {
+        value.type = JsonStreamValue::Bool;
+        value.boolean = token_[0] == 't';
+      } else if (strcmp(token_, "null") == 0) {
+        value.type = JsonStreamValue::Null;
+      } else {
+        return fail("Invalid JSON");
+      }
+    } else if (num_ == Num::Zero || num_ == Num::Int || num_ == Num::Frac || num_ == Num::ExpDigits) {
+      value.type = JsonStreamValue::Number;
+      value.truncated = tokenTruncated_;
+    } else {
+      return fail("Invalid JSON");
+    }
+    return emit(value);
+  }
+
+  static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  bool consume(char c) {
+    switch (lex_) {
+      case Lex::Text:
+        if (c == '"') {
+          return endString();
+        }
+        if (c == '\\') {
+          lex_ = Lex::Escape;
+          return true;
+        }
+        if (static_cast<uint8_t>(c) < 0x20) {
+          return fail("Invalid JSON");
+        }
+        return pushToken(c);
+      case Lex::Escape:
+        lex_ = Lex::Text;
+        switch (c) {
+          case '"': return pushToken('"');
+          case '\\': return pushToken('\\');
+          case '/': return pushToken('/');
+          case 'b': return pushToken('\b');
+          case 'f': return pushToken('\f');
+          case 'n': return pushToken('\n');
+          case 'r': return pushToken('\r');
+          case 't': return pushToken('\t');
+          case 'u':
+            lex_ = Lex::Unicode;
+            unicode_ = 0;
+            unicodeDigits_ = 0;
+            return true;
+        }
+        return fail("Invalid JSON");
+      case Lex::Unicode: {
+        const int digit = hexValue(c);
+        if (digit < 0) {
+          return fail("Invalid JSON");
+        }
+        unicode_ = static_cast<uint16_t>((unicode_ << 4) | digit);
+        if (++unicodeDigits_ < 4) {
+          return true;
+        }
+        lex_ = Lex::Text;
+        return pushUtf8(unicode_);
+      }
+      case Lex::Literal:
+        if (isLiteralChar(c)) {
+          if (!advanceLiteral(c)) {
+            return fail("Invalid JSON");
+          }
+          return pushToken(c);
+        }
+        if (!endLiteral()) {
+          return false;
+        }
+        break;
+      case Lex::None:
+        break;
+    }
+
+    if (isSpace(c)) {
+      return true;
+    }
+
+    switch (expect_) {
+      case Expect::Value:
+      case Expect::FirstValueOrEnd:
+        if (c == '{') return beginContainer(false);
+        if (c == '[') return beginContainer(true);
+        if (c == ']' && expect_ == Expect::FirstValueOrEnd) return endContainer(true);
+        tokenLength_ = 0;
+        tokenTruncated_ = false;
+        if (c == '"') {
+          lex_ = Lex::Text;
+          stringIsKey_ = false;
+          return true;
+        }
+        if (c == '-' || isDigit(c) || c == 't' || c == 'f' || c == 'n') {
+          return startLiteral(c);
+        }
+        return fail("Invalid JSON");
+      case Expect::Key:
+      case Expect::FirstKeyOrEnd:
+        if (c == '}' && expect_ == Expect::FirstKeyOrEnd) return endContainer(false);
+        if (c != '"') {
+          return fail("Invalid JSON");
+        }
+        tokenLength_ = 0;
+        tokenTruncated_ = false;
+        lex_ = Lex::Text;
+        stringIsKey_ = true;
+        return true;
+      case Expect::Colon:
+        if (c != ':') {
+          return fail("Invalid JSON");
+        }
+        expect_ = Expect::Value;
+        return true;
+      case Expect::CommaOrEnd: {
+        JsonStreamFrame& frame = frames_[depth_ - 1];
+        if (c == ',') {
+          if (frame.isArray) {
+            frame.index++;
+            expect_ = Expect::Value;
+          } else {
+            expect_ = Expect::Key;
+          }
+          return true;
+        }
+        if (c == (frame.isArray ? ']' : '}')) {
+          return endContainer(frame.isArray);
+        }
+        return fail("Invalid JSON");
+      }
+      case Expect::Done:
+        return fail("Invalid JSON");
+    }
+    return fail("Invalid JSON");
+  }
+
+  JsonStreamSink* sink_ = nullptr;
+  size_t maxBytes_ = 0;
+  size_t received_ = 0;
+  Expect expect_ = Expect::Value;
+  Lex lex_ = Lex::None;
+  bool stringIsKey_ = false;
+  char token_[JSON_STREAM_MAX_TOKEN + 1] = {};
+  uint16_t tokenLength_ = 0;
+  bool tokenTruncated_ = false;
+  Num num_ = Num::Keyword;
+  uint16_t unicode_ = 0;
+  uint8_t unicodeDigits_ = 0;
+  const char* error_ = nullptr;
+  bool sinkRejected_ = false;
+  bool tooLarge_ = false;
+  bool finished_ = false;
+};
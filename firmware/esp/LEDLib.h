@@ -9,22 +9,32 @@
 #define FASTLED_ESP32_I2S 1
 #endif
 #include <FastLED.h>
-CRGB* leds1 = NULL;
-CRGB* leds2 = NULL;
+// One buffer for every strip; each controller is registered at its strip's offset.
+CRGB* leds = NULL;
 #include "FastLEDLib.h"
 #endif
 
 #ifdef NEOPIXELBUS_ENABLED
 #include "NeoPixelBusStrip.h"
 // These are just declarations - actual initialization happens in setupNeoPixelBus()
-NeoPixelBusStrip* strip1 = NULL;
-NeoPixelBusStrip* strip2 = NULL;
+NeoPixelBusStrip* strips[OUTPUT_MAX_STRIPS] = {};
 #include "NeoPixelBusLib.h"
 #endif
 
+#ifdef VIRTUAL_LEDS_ENABLED
+#include "VirtualOutput.h"
+VirtualOutput virtualOutput;
+#include "VirtualLEDLib.h"
+#endif
+
+// The virtual output is a profiling/test backend, so it is only offered (in
+// /get_settings and led_library validation) by firmware built with it.
 static constexpr uint8_t KNOWN_LED_LIBRARIES[] = {
   LIB_NEOPIXELBUS,
-  LIB_FASTLED
+  LIB_FASTLED,
+#ifdef VIRTUAL_LEDS_ENABLED
+  LIB_VIRTUAL
+#endif
 };
 
 static constexpr uint8_t KNOWN_LED_TYPES[] = {
@@ -86,6 +96,15 @@ bool isLedTypeKnown(uint8_t ledType) {
   return false;
 }
 
+const char* ledLibraryName(uint8_t lib) {
+  switch (lib) {
+    case LIB_NEOPIXELBUS: return "NeoPixelBus";
+    case LIB_FASTLED: return "FastLED";
+    case LIB_VIRTUAL: return "Virtual";
+    default: return "Unknown";
+  }
+}
+
 bool isLedLibraryCompiled(uint8_t lib) {
   switch (lib) {
     case LIB_NEOPIXELBUS:
@@ -100,6 +119,12 @@ bool isLedLibraryCompiled(uint8_t lib) {
       #else
       return false;
       #endif
+    case LIB_VIRTUAL:
+      #ifdef VIRTUAL_LEDS_ENABLED
+      return true;
+      #else
+      return false;
+      #endif
     default:
       return false;
   }
@@ -143,6 +168,9 @@ uint8_t defaultAvailableLedLibrary() {
   if (isLedLibraryAvailable(LIB_NEOPIXELBUS)) {
     return LIB_NEOPIXELBUS;
   }
+  if (isLedLibraryAvailable(LIB_VIRTUAL)) {
+    return LIB_VIRTUAL;
+  }
   return ledLibrary;
 }
 
@@ -199,6 +227,9 @@ bool doesLedLibrarySupportType(uint8_t lib, uint8_t ledType) {
         default:
           return false;
       }
+    case LIB_VIRTUAL:
+      // Only the wire timing depends on the type; every known type is modelled.
+      return isLedTypeKnown(ledType);
     default:
       return false;
   }
@@ -268,7 +299,7 @@ void normalizeLedSelection() {
 
     uint8_t fallbackLibrary = defaultAvailableLedLibrary();
     if (fallbackLibrary != ledLibrary) {
-      LP_LOGLN("Switching LED library to " + String(fallbackLibrary == LIB_FASTLED ? "FastLED" : "NeoPixelBus"));
+      LP_LOGLN("Switching LED library to " + String(ledLibraryName(fallbackLibrary)));
       ledLibrary = fallbackLibrary;
     }
   }
@@ -292,16 +323,39 @@ void normalizeLedSelection() {
     uint8_t fallbackLibrary = firstAvailableLedLibraryForType(ledType);
     if (fallbackLibrary != ledLibrary && isLedTypeAvailableForLibrary(ledType, fallbackLibrary)) {
       LP_LOGLN("Switching LED library to match LED type " + String(ledType) + ": " +
-               String(fallbackLibrary == LIB_FASTLED ? "FastLED" : "NeoPixelBus"));
+               String(ledLibraryName(fallbackLibrary)));
       ledLibrary = fallbackLibrary;
     }
   }
+
+  // Per-strip types follow the library chosen above; an override it cannot drive
+  // falls back to the global type.
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    OutputStripConfig& output = outputs[i];
+    if (output.ledType != OUTPUT_INHERIT && !isLedTypeAvailableForLibrary(output.ledType, ledLibrary)) {
+      LP_LOGLN("LED type " + String(output.ledType) + " of strip " + String(i + 1) + " is not supported by " +
+               String(ledLibraryName(ledLibrary)) + "; using led_type");
+      output.ledType = OUTPUT_INHERIT;
+    }
+  }
 }
 
 void normalizeLedLibrarySelection() {
   normalizeLedSelection();
 }
 
+// Strips the selected backend can drive; the output map is limited to this so
+// the object, /get_colors and the advertised pixel counts match what is lit.
+uint8_t ledLibraryMaxStrips(uint8_t lib) {
+  #ifdef NEOPIXELBUS_ENABLED
+  if (lib == LIB_NEOPIXELBUS) {
+    return NPB_MAX_STRIPS;
+  }
+  #endif
+  (void)lib;
+  return OUTPUT_MAX_STRIPS;
+}
+
 void normalizeObjectTypeSelection() {
   if (!isSupportedObjectType(objectType)) {
     LP_LOGLN("Unsupported objectType=" + String(objectType) + ", falling back to OBJ_LINE");
@@ -312,21 +366,29 @@ void normalizeObjectTypeSelection() {
 void setupLEDs() {
   normalizeObjectTypeSelection();
 
-  if (objectType == OBJ_HEPTAGON919) {
-    pixelCount1 = HEPTAGON919_PIXEL_COUNT1;
-    pixelCount2 = HEPTAGON919_PIXEL_COUNT2;
-    pixelPin1 = 14;
-    pixelPin2 = 26;
-  }
-  else if (objectType == OBJ_HEPTAGON3024) {
-    pixelCount1 = HEPTAGON3024_REAL_PIXEL_COUNT1;
-    pixelCount2 = HEPTAGON3024_REAL_PIXEL_COUNT2;
+  if (objectType == OBJ_HEPTAGON919 || objectType == OBJ_HEPTAGON3024) {
+    const bool is919 = objectType == OBJ_HEPTAGON919;
+    // The heptagon wiring is two strips; extra strips would shift nothing onto it.
+    for (uint8_t i = 2; i < OUTPUT_MAX_STRIPS; i++) {
+      outputs[i].pixelCount = 0;
+    }
+    pixelCount1 = is919 ? HEPTAGON919_PIXEL_COUNT1 : HEPTAGON3024_REAL_PIXEL_COUNT1;
+    pixelCount2 = is919 ? HEPTAGON919_PIXEL_COUNT2 : HEPTAGON3024_REAL_PIXEL_COUNT2;
     pixelPin1 = 14;
     pixelPin2 = 26;
   }
 
   normalizeLedLibrarySelection();
 
+  outputMap.build(outputs, ledType, colorOrder, ledLibraryMaxStrips(ledLibrary));
+  if (outputMap.droppedStrips > 0) {
+    LP_LOGLN(String(ledLibraryName(ledLibrary)) + " drives at most " + String(ledLibraryMaxStrips(ledLibrary)) +
+             " strips on this target; ignoring " + String(outputMap.droppedStrips));
+  }
+  if (outputMap.truncated) {
+    LP_LOGLN("Output strips exceed " + String(OUTPUT_MAX_PIXELS) + " pixels; extra pixels are not driven");
+  }
+
   #ifdef NEOPIXELBUS_ENABLED
   setupNeoPixelBus();
   #endif
@@ -334,6 +396,12 @@ void setupLEDs() {
   #ifdef FASTLED_ENABLED
   setupFastLED();
   #endif
+
+  #ifdef VIRTUAL_LEDS_ENABLED
+  setupVirtualLEDs();
+  #endif
+
+  markOutputDirty();
 }
 
 void setupState() {
@@ -346,13 +414,13 @@ void setupState() {
     object = new Heptagon3024();
   }
   else if (objectType == OBJ_LINE) {
-    object = new Line(pixelCount1 + pixelCount2);
+    object = new Line(outputMap.totalPixels);
   }
   else if (objectType == OBJ_TRIANGLE) {
-    object = new Triangle(pixelCount1 + pixelCount2);
+    object = new Triangle(outputMap.totalPixels);
   }
   else {
-    object = new Line(pixelCount1 + pixelCount2);
+    object = new Line(outputMap.totalPixels);
   }
 
   state = new State(*object);
@@ -362,11 +430,39 @@ void setupState() {
 
   // Set auto emitter enabled state
   state->autoEnabled = emitterEnabled;
+  markOutputDirty();
 
   LP_LOGLN("State initialized");
 }
 
+// Layer configuration and the active palette, captured from the live State so
+// they can be reapplied after State is recreated without re-reading layers.json.
+struct RuntimeLayerCarryOver {
+  DynamicJsonDocument layersDoc{0};
+  uint8_t currentPalette = 0;
+
+  void capture() {
+    if (state == nullptr) {
+      return;
+    }
+    currentPalette = state->currentPalette;
+    layersDoc = DynamicJsonDocument(layersDocCapacity());
+    JsonArray layersArray = layersDoc.to<JsonArray>();
+    serializeLayers(layersArray);
+  }
+
+  void restore() {
+    state->currentPalette = currentPalette;
+    JsonArray layersArray = layersDoc.as<JsonArray>();
+    processLayersArray(layersArray);
+  }
+};
+
+// Recreates object and State after an object type or pixel count change.
 void rebuildRuntimeState() {
+  RuntimeLayerCarryOver carryOver;
+  carryOver.capture();
+
   #ifdef DEBUGGER_ENABLED
   if (debugger != nullptr) {
     delete debugger;
@@ -384,26 +480,163 @@ void rebuildRuntimeState() {
   }
 
   setupState();
+  carryOver.restore();
 
-  #ifdef SPIFFS_ENABLED
-  loadLayers();
+  #ifdef DEBUGGER_ENABLED
+  debugger = new Debugger(*object);
   #endif
+}
+
+// Recreates State for the current object after its topology was replaced, since
+// running lights hold pointers into the old graph. Layers carry over and emitted
+// lights still in flight are retired. Called from request handlers, so the swap
+// completes between two frames and the next drawLEDs() shows the restored layers.
+void swapRuntimeState() {
+  RuntimeLayerCarryOver carryOver;
+  carryOver.capture();
+
+  if (state != nullptr) {
+    delete state;
+    state = nullptr;
+  }
+  state = new State(*object);
+  State::autoParams.from = emitterFrom;
+  state->autoEnabled = emitterEnabled;
+  carryOver.restore();
 
   #ifdef DEBUGGER_ENABLED
+  if (debugger != nullptr) {
+    delete debugger;
+  }
   debugger = new Debugger(*object);
   #endif
+
+  markOutputDirty();
 }
 
-void updateLEDs() {
-  gMillis = millis();
+// Optional fixed-timestep stepping. With simTickHz > 0 the state advances in
+// whole logical ticks and gMillis follows the logical clock, so motion does not
+// depend on how long the rest of the loop (HTTP, OSC, Show()) took. Catch-up is
+// bounded per loop; older backlog is dropped and the logical clock skips over
+// it, so gMillis never lags millis() by more than a tick.
+constexpr uint8_t SIM_MAX_CATCHUP_TICKS = 4;
+// Rate the logical clock was started at; 0 while gMillis follows millis().
+uint16_t simClockHz = 0;
+unsigned long simLastMicros = 0;
+unsigned long simAccumulatorMicros = 0;
+uint64_t simLogicalMicros = 0;
+uint32_t simDroppedTicks = 0;
+
+// Set when the composed pixels no longer match the layer settings without a
+// tick having run (a /get_colors layer preview). A loop that steps no tick then
+// recomposes before drawing instead of showing the stale composite.
+bool stateCompositeStale = false;
+
+void stepState() {
   #ifdef DEBUGGER_ENABLED
   debugger->update(gMillis);
   #endif
   state->autoEmit(gMillis);
+  AllocScope allocScope(ALLOC_PHASE_UPDATE);
   state->update();
+  stateCompositeStale = false;
+}
+
+// Restarts the logical clock from the current gMillis when sim_tick_hz changes.
+// Leaving fixed-step mode hands gMillis back to millis(); since dropped backlog
+// is skipped, that step forward is at most one tick.
+void restartSimClock() {
+  simClockHz = simTickHz;
+  simLastMicros = micros();
+  simAccumulatorMicros = simClockHz > 0 ? 1000000UL / simClockHz : 0;
+  simLogicalMicros = static_cast<uint64_t>(gMillis) * 1000ULL;
+}
+
+void updateLEDs() {
+  if (simTickHz != simClockHz) {
+    restartSimClock();
+  }
+
+  if (simClockHz == 0) {
+    gMillis = millis();
+    stepState();
+    return;
+  }
+
+  const unsigned long nowMicros = micros();
+  const unsigned long tickMicros = 1000000UL / simClockHz;
+  simAccumulatorMicros += nowMicros - simLastMicros;
+  simLastMicros = nowMicros;
+
+  uint8_t steps = 0;
+  while (simAccumulatorMicros >= tickMicros && steps < SIM_MAX_CATCHUP_TICKS) {
+    simAccumulatorMicros -= tickMicros;
+    simLogicalMicros += tickMicros;
+    gMillis = static_cast<unsigned long>(simLogicalMicros / 1000ULL);
+    stepState();
+    steps++;
+  }
+
+  if (simAccumulatorMicros >= tickMicros) {
+    const unsigned long dropped = simAccumulatorMicros / tickMicros;
+    simDroppedTicks += dropped;
+    simAccumulatorMicros %= tickMicros;
+    simLogicalMicros += static_cast<uint64_t>(dropped) * tickMicros;
+    gMillis = static_cast<unsigned long>(simLogicalMicros / 1000ULL);
+  }
+
+  if (steps == 0 && stateCompositeStale) {
+    AllocScope allocScope(ALLOC_PHASE_UPDATE);
+    state->update();
+    stateCompositeStale = false;
+  }
+}
+
+// Folds the inputs that can change a static frame into `signature` and returns
+// whether the frame is static (no emitted lights, auto emitter or moving layers).
+// Single pass over the light-list slots, since this runs every loop. It is still
+// O(MAX_LIGHT_LISTS): the lists are created and freed inside the lightgraph core
+// (emit, stopNote), so only State can keep an active-slot index for it to walk.
+bool collectOutputFrameInputs(uint32_t& signature) {
+  signature = outputHashMix(OUTPUT_HASH_SEED, gOutputDirtyEpoch);
+  signature = outputHashMix(signature, wledMasterOn ? maxBrightness : 0);
+  signature = outputHashMix(signature, ledLibrary);
+  if (state == nullptr) {
+    return false;
+  }
+  signature = outputHashMix(signature, state->currentPalette);
+  signature = outputHashMix(signature, (state->showIntersections ? 1u : 0u) | (state->showConnections ? 2u : 0u));
+
+  bool isStatic = !state->autoEnabled;
+  for (uint8_t i = 0; i < MAX_LIGHT_LISTS; i++) {
+    LightList* list = state->lightLists[i];
+    if (list == nullptr) {
+      continue;
+    }
+    // Non-editable lists are emitted lights still in flight.
+    if (!list->editable) {
+      isStatic = false;
+      continue;
+    }
+    if (list->visible && list->speed != 0) {
+      isStatic = false;
+    }
+    signature = outputHashMix(signature, i);
+    signature = outputHashMix(signature, list->visible ? 1u : 0u);
+    signature = outputHashMix(signature, static_cast<uint32_t>(list->blendMode));
+    signature = outputHashMix(signature, (static_cast<uint32_t>(list->minBri) << 8) | list->maxBri);
+  }
+  return isStatic;
 }
 
 void drawLEDs() {
+  uint32_t signature = 0;
+  const bool staticInputs = collectOutputFrameInputs(signature);
+  if (!shouldComposeOutputFrame(staticInputs, signature, outputRefreshMs)) {
+    return;
+  }
+  beginOutputFrame();
+
   #ifdef NEOPIXELBUS_ENABLED
   drawNeoPixelBus();
   #endif
@@ -411,6 +644,10 @@ void drawLEDs() {
   #ifdef FASTLED_ENABLED
   drawFastLED();
   #endif
+
+  #ifdef VIRTUAL_LEDS_ENABLED
+  drawVirtualLEDs();
+  #endif
 }
 
 void doEmit(EmitParams &params) {
@@ -435,6 +672,8 @@ void doEmit(EmitParams &params) {
 }
 
 void doCommand(char command) {
+  traceCommand(command);
+  markOutputDirty();
   switch (command) {
     case 'r':
       ESP.restart();
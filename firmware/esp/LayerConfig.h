@@ -0,0 +1,240 @@
+#pragma once
+
+#include <ArduinoJson.h>
+
+// Layer configuration as JSON: layers.json (FSLib.h) and the in-memory
+// carry-over across State rebuilds (LEDLib.h) both use it, so it does not
+// depend on SPIFFS_ENABLED.
+
+// Members serializeLayers() may write per layer.
+constexpr size_t LAYER_JSON_FIELDS = 15;
+
+// JsonDocument capacity for serializeLayers() output under a root object or
+// array, sized from the live layers so palettes of any length fit. Keys are
+// string literals and values are numbers, so nothing is copied into the pool.
+size_t layersDocCapacity() {
+  size_t capacity = JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(MAX_LIGHT_LISTS);
+  if (!state) {
+    return capacity;
+  }
+  for (uint8_t i = 0; i < MAX_LIGHT_LISTS; i++) {
+    LightList* list = state->lightLists[i];
+    if (!list || !list->editable) {
+      continue;
+    }
+    capacity += JSON_OBJECT_SIZE(LAYER_JSON_FIELDS);
+    if (list->hasPalette()) {
+      const Palette& palette = list->getPalette();
+      capacity += JSON_ARRAY_SIZE(palette.getColors().size()) + JSON_ARRAY_SIZE(palette.getPositions().size());
+    }
+  }
+  return capacity;
+}
+
+// Helper function to process layers array data
+void processLayersArray(JsonArray& layersArray) {
+  for (JsonObject layerObj : layersArray) {
+    if (!layerObj.containsKey("index")) continue;
+
+    uint8_t index = layerObj["index"].as<uint8_t>();
+    if (index >= MAX_LIGHT_LISTS) continue;
+    if (!state->lightLists[index]) {
+      state->setupBg(index);
+    }
+
+    // Set visibility
+    if (layerObj.containsKey("visible")) {
+      state->lightLists[index]->visible = layerObj["visible"].as<bool>();
+    }
+
+    // Set brightness
+    if (layerObj.containsKey("brightness")) {
+      uint8_t brightness = layerObj["brightness"].as<uint8_t>();
+      state->lightLists[index]->maxBri = brightness;
+      if (state->lightLists[index]->minBri > brightness) {
+        state->lightLists[index]->minBri = brightness;
+      }
+    }
+    
+    // Set blend mode
+    if (layerObj.containsKey("blendMode")) {
+      uint8_t blendMode = layerObj["blendMode"].as<uint8_t>();
+      if (blendMode <= BLEND_PIN_LIGHT) {
+        state->lightLists[index]->blendMode = static_cast<BlendMode>(blendMode);
+      }
+    }
+    
+    // Set speed
+    if (layerObj.containsKey("speed")) {
+      float speed = layerObj["speed"].as<float>();
+      if (speed >= -10.0f && speed <= 10.0f) {
+        // Save the current speed, will apply with the ease function
+        state->lightLists[index]->speed = speed;
+      }
+    }
+    
+    // Set ease function
+    if (layerObj.containsKey("ease")) {
+      uint8_t ease = layerObj["ease"].as<uint8_t>();
+      if (ease <= EASE_ELASTIC_INOUT) {
+        // Use the setSpeed function to set both speed and ease
+        float currentSpeed = state->lightLists[index]->speed;
+        state->lightLists[index]->setSpeed(currentSpeed, ease);
+      }
+    }
+    
+    // Set fade speed
+    if (layerObj.containsKey("fadeSpeed")) {
+      uint8_t fadeSpeed = layerObj["fadeSpeed"].as<uint8_t>();
+      uint8_t currentFadeThresh = state->lightLists[index]->fadeThresh;
+      uint8_t currentFadeEase = state->lightLists[index]->fadeEaseIndex;
+      state->lightLists[index]->setFade(fadeSpeed, currentFadeThresh, currentFadeEase);
+    }
+    
+    // Set behaviour flags
+    if (layerObj.containsKey("behaviourFlags")) {
+      uint16_t behaviourFlags = layerObj["behaviourFlags"].as<uint16_t>();
+      
+      // Check if behaviour object exists
+      if (!state->lightLists[index]->behaviour) {
+        // Create a new behaviour object with the specified flags
+        state->lightLists[index]->behaviour = new Behaviour(behaviourFlags);
+      } else {
+        // Update existing behaviour flags
+        state->lightLists[index]->behaviour->flags = behaviourFlags;
+      }
+    }
+
+    // Set offset
+    if (layerObj.containsKey("offset")) {
+      float offset = layerObj["offset"].as<float>();
+      state->lightLists[index]->setOffset(offset);
+    }
+
+    // Set palette for this layer
+    if (layerObj.containsKey("colors") && layerObj["colors"].is<JsonArray>()) {
+      std::vector<int64_t> layerColors;
+      std::vector<float> layerPositions;
+
+      // Load colors
+      JsonArray colorsArray = layerObj["colors"].as<JsonArray>();
+      for (JsonVariant color : colorsArray) {
+        layerColors.push_back(color.as<int64_t>());
+      }
+
+      // Load positions
+      if (layerObj.containsKey("positions") && layerObj["positions"].is<JsonArray>()) {
+        JsonArray positionsArray = layerObj["positions"].as<JsonArray>();
+        for (JsonVariant pos : positionsArray) {
+          layerPositions.push_back(pos.as<float>());
+        }
+      }
+
+      // Ensure positions match colors
+      if (layerPositions.size() != layerColors.size()) {
+        layerPositions.clear();
+        for (size_t i = 0; i < layerColors.size(); i++) {
+          float pos = (layerColors.size() == 1) ? 0.0f :
+                    static_cast<float>(i) / static_cast<float>(layerColors.size() - 1);
+          layerPositions.push_back(pos);
+        }
+      }
+
+      // Create palette
+      if (layerColors.size() > 0) {
+        Palette palette(layerColors, layerPositions);
+
+        // Set color rule
+        if (layerObj.containsKey("colorRule")) {
+          palette.setColorRule(layerObj["colorRule"].as<int8_t>());
+        }
+
+        // Set interpolation mode
+        if (layerObj.containsKey("interMode")) {
+          palette.setInterMode(layerObj["interMode"].as<int8_t>());
+        }
+
+        // Set wrap mode
+        if (layerObj.containsKey("wrapMode")) {
+          palette.setWrapMode(layerObj["wrapMode"].as<int8_t>());
+        }
+
+        // Set segmentation
+        if (layerObj.containsKey("segmentation")) {
+          palette.setSegmentation(layerObj["segmentation"].as<float>());
+        }
+
+        // Set the palette on the light list
+        state->lightLists[index]->setPalette(palette);
+      }
+    }
+  }
+}
+
+// Writes the configuration of every editable light list (layer) in the format
+// processLayersArray() reads. Emitted lists still in flight are skipped.
+void serializeLayers(JsonArray& layersArray) {
+  if (!state) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < MAX_LIGHT_LISTS; i++) {
+    if (state->lightLists[i] && state->lightLists[i]->editable) {
+      JsonObject layerObj = layersArray.createNestedObject();
+
+      // Save layer index
+      layerObj["index"] = i;
+
+      // Save visibility
+      layerObj["visible"] = state->lightLists[i]->visible;
+
+      // Save brightness
+      layerObj["brightness"] = state->lightLists[i]->maxBri;
+      
+      // Save blend mode
+      layerObj["blendMode"] = static_cast<uint8_t>(state->lightLists[i]->blendMode);
+      
+      // Save speed
+      layerObj["speed"] = state->lightLists[i]->speed;
+      
+      // Use the stored easeIndex
+      layerObj["ease"] = state->lightLists[i]->easeIndex;
+      
+      // Save fade speed
+      layerObj["fadeSpeed"] = state->lightLists[i]->fadeSpeed;
+      
+      // Save offset
+      layerObj["offset"] = state->lightLists[i]->getOffset();
+      
+      // Save behaviour flags
+      if (state->lightLists[i]->behaviour) {
+        layerObj["behaviourFlags"] = state->lightLists[i]->behaviour->flags;
+      }
+
+      // Save palette if available
+      if (state->lightLists[i]->hasPalette()) {
+        const Palette& palette = state->lightLists[i]->getPalette();
+
+        // Save palette colors
+        JsonArray colorsArray = layerObj.createNestedArray("colors");
+        const std::vector<int64_t>& colors = palette.getColors();
+        for (const auto& color : colors) {
+          colorsArray.add(color);
+        }
+
+        // Save palette positions
+        JsonArray positionsArray = layerObj.createNestedArray("positions");
+        const std::vector<float>& positions = palette.getPositions();
+        for (const auto& pos : positions) {
+          positionsArray.add(pos);
+        }
+
+        // Save palette properties
+        layerObj["colorRule"] = palette.getColorRule();
+        layerObj["interMode"] = palette.getInterMode();
+        layerObj["wrapMode"] = palette.getWrapMode();
+        layerObj["segmentation"] = palette.getSegmentation();
+      }
+    }
+  }
+}
@@ -2,6 +2,7 @@
 
 #define LIB_NEOPIXELBUS 0
 #define LIB_FASTLED 1
+#define LIB_VIRTUAL 2
 
 #define LED_WS2812 0
 #define LED_WS2811 1
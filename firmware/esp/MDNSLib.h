@@ -29,7 +29,7 @@ void setupMDNSService() {
     MDNS.addServiceTxt(MDNS_XLED_SERVICE, MDNS_TCP, "ip", WiFi.localIP().toString());
     MDNS.addServiceTxt(MDNS_XLED_SERVICE, MDNS_TCP, "name", deviceHostname);
     MDNS.addServiceTxt(MDNS_XLED_SERVICE, MDNS_TCP, "type", "DIY");
-    MDNS.addServiceTxt(MDNS_XLED_SERVICE, MDNS_TCP, "lights", String(pixelCount1 + pixelCount2));
+    MDNS.addServiceTxt(MDNS_XLED_SERVICE, MDNS_TCP, "lights", String(outputMap.totalPixels));
     MDNS.addServiceTxt(MDNS_XLED_SERVICE, MDNS_TCP, "version", "1.0.0");
 
     MDNS.addService(MDNS_WLED_SERVICE, MDNS_TCP, 80);
@@ -38,7 +38,7 @@ void setupMDNSService() {
     MDNS.addServiceTxt(MDNS_WLED_SERVICE, MDNS_TCP, "ip", WiFi.localIP().toString());
     MDNS.addServiceTxt(MDNS_WLED_SERVICE, MDNS_TCP, "name", deviceHostname);
     MDNS.addServiceTxt(MDNS_WLED_SERVICE, MDNS_TCP, "type", "DIY");
-    MDNS.addServiceTxt(MDNS_WLED_SERVICE, MDNS_TCP, "lights", String(pixelCount1 + pixelCount2));
+    MDNS.addServiceTxt(MDNS_WLED_SERVICE, MDNS_TCP, "lights", String(outputMap.totalPixels));
     MDNS.addServiceTxt(MDNS_WLED_SERVICE, MDNS_TCP, "version", "1.0.0");
     
     MDNS.addService(MDNS_HTTP_SERVICE, MDNS_TCP, 80);
@@ -46,7 +46,7 @@ void setupMDNSService() {
     MDNS.addServiceTxt(MDNS_HTTP_SERVICE, MDNS_TCP, "ip", WiFi.localIP().toString());
     MDNS.addServiceTxt(MDNS_HTTP_SERVICE, MDNS_TCP, "name", deviceHostname);
     MDNS.addServiceTxt(MDNS_HTTP_SERVICE, MDNS_TCP, "type", "DIY");
-    MDNS.addServiceTxt(MDNS_HTTP_SERVICE, MDNS_TCP, "lights", String(pixelCount1 + pixelCount2));
+    MDNS.addServiceTxt(MDNS_HTTP_SERVICE, MDNS_TCP, "lights", String(outputMap.totalPixels));
     MDNS.addServiceTxt(MDNS_HTTP_SERVICE, MDNS_TCP, "version", "1.0.0");
     
     LP_LOGLN("mDNS services added: _wled._tcp and _http._tcp");
@@ -46,6 +46,21 @@ NeoGamma<NeoGammaTableMethod> colorGamma;
 #define NPB_METHOD_STRIP2_TM1914 NeoEsp32I2s1Tm1914Method
 #define NPB_METHOD_STRIP1_APA106 NeoEsp32I2s0Apa106Method
 #define NPB_METHOD_STRIP2_APA106 NeoEsp32I2s1Apa106Method
+#define NPB_METHOD_PARALLEL_WS2812X NeoEsp32I2s1X8Ws2812xMethod
+#define NPB_METHOD_PARALLEL_WS2812 NeoEsp32I2s1X8800KbpsMethod
+#define NPB_METHOD_PARALLEL_WS2811 NeoEsp32I2s1X8400KbpsMethod
+#define NPB_METHOD_PARALLEL_WS2813 NeoEsp32I2s1X8Ws2812xMethod
+#define NPB_METHOD_PARALLEL_WS2814 NeoEsp32I2s1X8Ws2814Method
+#define NPB_METHOD_PARALLEL_WS2816 NeoEsp32I2s1X8Ws2812xMethod
+#define NPB_METHOD_PARALLEL_SK6812 NeoEsp32I2s1X8Sk6812Method
+#define NPB_METHOD_PARALLEL_TM1814 NeoEsp32I2s1X8Tm1814Method
+#define NPB_METHOD_PARALLEL_TM1829 NeoEsp32I2s1X8Tm1829Method
+#define NPB_METHOD_PARALLEL_TM1914 NeoEsp32I2s1X8Tm1914Method
+#define NPB_METHOD_PARALLEL_APA106 NeoEsp32I2s1X8Apa106Method
+// I2S0 and I2S1 drive two strips independently; more strips share I2S1 in x8 parallel mode.
+#define NPB_INDEPENDENT_STRIPS 2
+#define NPB_MAX_STRIPS 8
+#define NPB_ALWAYS_SHARED_BUS 0
 #define NPB_TRANSPORT_NAME "esp32-i2s"
 #elif defined(NPB_TARGET_ESP32S3)
 // Keep S3 on LCD-X transport to avoid ESP-IDF RMT legacy/new-driver conflicts.
@@ -72,6 +87,22 @@ NeoGamma<NeoGammaTableMethod> colorGamma;
 #define NPB_METHOD_STRIP2_TM1914 NeoEsp32LcdX8Tm1914Method
 #define NPB_METHOD_STRIP1_APA106 NeoEsp32LcdX8Apa106Method
 #define NPB_METHOD_STRIP2_APA106 NeoEsp32LcdX8Apa106Method
+#define NPB_METHOD_PARALLEL_WS2812X NPB_METHOD_STRIP1_WS2812X
+#define NPB_METHOD_PARALLEL_WS2812 NPB_METHOD_STRIP1_WS2812
+#define NPB_METHOD_PARALLEL_WS2811 NPB_METHOD_STRIP1_WS2811
+#define NPB_METHOD_PARALLEL_WS2813 NPB_METHOD_STRIP1_WS2813
+#define NPB_METHOD_PARALLEL_WS2814 NPB_METHOD_STRIP1_WS2814
+#define NPB_METHOD_PARALLEL_WS2816 NPB_METHOD_STRIP1_WS2816
+#define NPB_METHOD_PARALLEL_SK6812 NPB_METHOD_STRIP1_SK6812
+#define NPB_METHOD_PARALLEL_TM1814 NPB_METHOD_STRIP1_TM1814
+#define NPB_METHOD_PARALLEL_TM1829 NPB_METHOD_STRIP1_TM1829
+#define NPB_METHOD_PARALLEL_TM1914 NPB_METHOD_STRIP1_TM1914
+#define NPB_METHOD_PARALLEL_APA106 NPB_METHOD_STRIP1_APA106
+// Every strip is already a lane of the LCD x8 bus, so all of them shift out
+// together and share one bit timing even when there are only one or two.
+#define NPB_INDEPENDENT_STRIPS OUTPUT_MAX_STRIPS
+#define NPB_MAX_STRIPS 8
+#define NPB_ALWAYS_SHARED_BUS 1
 #define NPB_TRANSPORT_NAME "esp32s3-lcdx"
 #else
 #define NPB_METHOD_STRIP1_WS2812X NeoEsp32Rmt0Ws2812xMethod
@@ -96,6 +127,21 @@ NeoGamma<NeoGammaTableMethod> colorGamma;
 #define NPB_METHOD_STRIP2_TM1914 NeoEsp32Rmt1Tm1914Method
 #define NPB_METHOD_STRIP1_APA106 NeoEsp32Rmt0Apa106Method
 #define NPB_METHOD_STRIP2_APA106 NeoEsp32Rmt1Apa106Method
+#define NPB_METHOD_PARALLEL_WS2812X NPB_METHOD_STRIP1_WS2812X
+#define NPB_METHOD_PARALLEL_WS2812 NPB_METHOD_STRIP1_WS2812
+#define NPB_METHOD_PARALLEL_WS2811 NPB_METHOD_STRIP1_WS2811
+#define NPB_METHOD_PARALLEL_WS2813 NPB_METHOD_STRIP1_WS2813
+#define NPB_METHOD_PARALLEL_WS2814 NPB_METHOD_STRIP1_WS2814
+#define NPB_METHOD_PARALLEL_WS2816 NPB_METHOD_STRIP1_WS2816
+#define NPB_METHOD_PARALLEL_SK6812 NPB_METHOD_STRIP1_SK6812
+#define NPB_METHOD_PARALLEL_TM1814 NPB_METHOD_STRIP1_TM1814
+#define NPB_METHOD_PARALLEL_TM1829 NPB_METHOD_STRIP1_TM1829
+#define NPB_METHOD_PARALLEL_TM1914 NPB_METHOD_STRIP1_TM1914
+#define NPB_METHOD_PARALLEL_APA106 NPB_METHOD_STRIP1_APA106
+// No parallel transport here: one RMT channel per strip.
+#define NPB_INDEPENDENT_STRIPS 2
+#define NPB_MAX_STRIPS 2
+#define NPB_ALWAYS_SHARED_BUS 0
 #define NPB_TRANSPORT_NAME "esp32-rmt-legacy"
 #endif
 
@@ -131,93 +177,108 @@ NeoPixelBusStrip* createNeoPixelBusStripWithMethod(uint8_t colorOrder, uint16_t
   }
 }
 
-template<typename T_METHOD_STRIP1, typename T_METHOD_STRIP2>
-NeoPixelBusStrip* createNeoPixelBusStripWithMethodPair(
+// Strips within NPB_INDEPENDENT_STRIPS use their own output peripheral; larger
+// maps put every strip on the parallel bus so all of them shift out together
+// and the frame takes as long as the longest strip.
+template<typename T_METHOD_STRIP1, typename T_METHOD_STRIP2, typename T_METHOD_PARALLEL>
+NeoPixelBusStrip* createNeoPixelBusStripWithMethods(
     uint8_t colorOrder,
     uint16_t pixelCount,
     uint8_t pixelPin,
-    bool isSecondStrip) {
-  if (isSecondStrip) {
+    uint8_t stripIndex,
+    bool parallel) {
+  if (parallel) {
+    return createNeoPixelBusStripWithMethod<T_METHOD_PARALLEL>(colorOrder, pixelCount, pixelPin);
+  }
+  if (stripIndex > 0) {
     return createNeoPixelBusStripWithMethod<T_METHOD_STRIP2>(colorOrder, pixelCount, pixelPin);
   }
   return createNeoPixelBusStripWithMethod<T_METHOD_STRIP1>(colorOrder, pixelCount, pixelPin);
 }
 
+#define NPB_STRIP_METHODS(TYPE) NPB_METHOD_STRIP1_##TYPE, NPB_METHOD_STRIP2_##TYPE, NPB_METHOD_PARALLEL_##TYPE
+
 NeoPixelBusStrip* createNeoPixelBusStrip(
     uint8_t ledType,
     uint8_t colorOrder,
     uint16_t pixelCount,
     uint8_t pixelPin,
-    bool isSecondStrip) {
+    uint8_t stripIndex,
+    bool parallel) {
   switch (ledType) {
     case LED_WS2811:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_WS2811, NPB_METHOD_STRIP2_WS2811>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(WS2811)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_WS2815:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_WS2812X, NPB_METHOD_STRIP2_WS2812X>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(WS2812X)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_WS2813:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_WS2813, NPB_METHOD_STRIP2_WS2813>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(WS2813)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_WS2816:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_WS2816, NPB_METHOD_STRIP2_WS2816>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(WS2816)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_SK6812:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_SK6812, NPB_METHOD_STRIP2_SK6812>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(SK6812)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_TM1829:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_TM1829, NPB_METHOD_STRIP2_TM1829>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(TM1829)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_APA106:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_APA106, NPB_METHOD_STRIP2_APA106>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(APA106)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_WS2814:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_WS2814, NPB_METHOD_STRIP2_WS2814>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(WS2814)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_TM1814:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_TM1814, NPB_METHOD_STRIP2_TM1814>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(TM1814)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_TM1914:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_TM1914, NPB_METHOD_STRIP2_TM1914>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(TM1914)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
     case LED_WS2812:
     default:
-      return createNeoPixelBusStripWithMethodPair<NPB_METHOD_STRIP1_WS2812, NPB_METHOD_STRIP2_WS2812>(
-          colorOrder, pixelCount, pixelPin, isSecondStrip);
+      return createNeoPixelBusStripWithMethods<NPB_STRIP_METHODS(WS2812)>(
+          colorOrder, pixelCount, pixelPin, stripIndex, parallel);
   }
 }
 
 void setupNeoPixelBus() {
-  if (ledLibrary != LIB_NEOPIXELBUS) return;
-
   // Clean up previous instances if they exist
-  if (strip1 != NULL) {
-    delete strip1;
-    strip1 = NULL;
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    if (strips[i] != NULL) {
+      delete strips[i];
+      strips[i] = NULL;
+    }
   }
 
-  if (strip2 != NULL) {
-    delete strip2;
-    strip2 = NULL;
-  }
+  if (ledLibrary != LIB_NEOPIXELBUS) return;
 
-  strip1 = createNeoPixelBusStrip(ledType, colorOrder, pixelCount1, pixelPin1, false);
-  strip1->Begin();
-  strip1->Show();
+  // setupLEDs() already limited the map to NPB_MAX_STRIPS.
+  const uint8_t stripCount = outputMap.stripCount;
 
-  if (pixelCount2 > 0) {
-    strip2 = createNeoPixelBusStrip(ledType, colorOrder, pixelCount2, pixelPin2, true);
-    strip2->Begin();
-    strip2->Show();
+  // Lanes of a shared x8 bus use one bit timing, taken from the first strip.
+  const bool parallel = stripCount > NPB_INDEPENDENT_STRIPS;
+  const bool sharedBus = parallel || NPB_ALWAYS_SHARED_BUS;
+  if (sharedBus && outputMap.hasMixedLedTypes()) {
+    LP_LOGLN("NeoPixelBus shared bus uses ledType of strip 1 for all strips");
   }
 
-  LP_LOGLN("NeoPixelBus transport = " + String(NPB_TRANSPORT_NAME));
-  LP_LOGLN("NeoPixelBus initialized with ledType = " + String(neoPixelBusLedTypeName(ledType)) +
-           ", colorOrder = " + String(colorOrder));
+  for (uint8_t i = 0; i < stripCount; i++) {
+    const OutputStrip& output = outputMap.strips[i];
+    const uint8_t stripLedType = sharedBus ? outputMap.strips[0].ledType : output.ledType;
+    strips[i] = createNeoPixelBusStrip(stripLedType, output.colorOrder, output.count, output.pin, i, parallel);
+    strips[i]->Begin();
+    strips[i]->Show();
+  }
+
+  LP_LOGLN("NeoPixelBus transport = " + String(NPB_TRANSPORT_NAME) + (parallel ? " (parallel)" : ""));
+  LP_LOGLN("NeoPixelBus initialized with " + String(stripCount) + " strip(s), ledType = " +
+           String(neoPixelBusLedTypeName(ledType)) + ", colorOrder = " + String(colorOrder));
 }
 
-RgbwColor handleWhite(RgbwColor color) {
-  if (HAS_WHITE(colorOrder)) {
+RgbwColor handleWhite(RgbwColor color, uint8_t order) {
+  if (HAS_WHITE(order)) {
     uint8_t minRGB = min(color.R, min(color.G, color.B));
     color.R -= minRGB;
     color.G -= minRGB;
@@ -227,16 +288,16 @@ RgbwColor handleWhite(RgbwColor color) {
   return color;
 }
 
-RgbwColor getNeoPixelColor(uint16_t i) {
+RgbwColor getNeoPixelColor(uint16_t i, uint8_t order = colorOrder) {
   const uint8_t effectiveBrightness = wledMasterOn ? maxBrightness : 0;
   ColorRGB pixel = state->getPixel(state->object.translateToLogicalPixel(i), effectiveBrightness);
-  RgbwColor color = handleWhite(RgbwColor(pixel.R, pixel.G, pixel.B, 0));
+  RgbwColor color = handleWhite(RgbwColor(pixel.R, pixel.G, pixel.B, 0), order);
   #ifdef DEBUGGER_ENABLED
   if (state->showConnections) {
-    color.G = (debugger->isConnection(i) ? 1.f : 0.f) * effectiveBrightness;
+    color.G = debugger->isConnection(i) ? effectiveBrightness : 0;
   }
   if (state->showIntersections) {
-    color.B = (debugger->isIntersection(i) ? 1.f : 0.f) * effectiveBrightness;
+    color.B = debugger->isIntersection(i) ? effectiveBrightness : 0;
   }
   #endif
   #ifdef COLORGAMMA_CORRECT
@@ -246,49 +307,46 @@ RgbwColor getNeoPixelColor(uint16_t i) {
   #endif
 }
 
-float getWatts(RgbColor color, float wattsPerLed = 0.2f) {
-  float relPixelPower = (float) (color.R + color.G + color.B) / (255.f * 3.f);
-  float wattsPerPixel = wattsPerLed * 3.f;
-  return relPixelPower * wattsPerPixel;
+uint16_t getChannelSum(const RgbColor& color) {
+  return color.R + color.G + color.B;
 }
 
-float getWatts(RgbwColor color, float wattsPerLed = 0.2f) {
-  float relPixelPower = (float) (color.R + color.G + color.B + color.W) / (255.f * 4.f);
-  float wattsPerPixel = wattsPerLed * 4.f;
-  return relPixelPower * wattsPerPixel;
+uint16_t getChannelSum(const RgbwColor& color) {
+  return color.R + color.G + color.B + color.W;
 }
 
 void drawNeoPixelBus() {
-  if (ledLibrary == LIB_NEOPIXELBUS && strip1 != NULL) {
-    totalWattage = 0;
-    // For the first strip
-    for (uint16_t i=0; i<pixelCount1; i++) {
-      RgbwColor color = getNeoPixelColor(i);
-      if (strip1->SupportsRgbw()) {
-        totalWattage += getWatts(color);
-        strip1->SetPixelColor(i, color);
+  if (ledLibrary != LIB_NEOPIXELBUS || strips[0] == NULL) {
+    return;
+  }
+
+  uint32_t channelSum = 0;
+  for (uint8_t s = 0; s < OUTPUT_MAX_STRIPS && strips[s] != NULL; s++) {
+    NeoPixelBusStrip* strip = strips[s];
+    const OutputStrip& output = outputMap.strips[s];
+    const bool rgbw = strip->SupportsRgbw();
+    for (uint16_t i=0; i<output.count; i++) {
+      RgbwColor color = getNeoPixelColor(output.start + i, output.colorOrder);
+      if (rgbw) {
+        channelSum += getChannelSum(color);
+        strip->SetPixelColor(i, color);
       } else {
         RgbColor rgb = RgbColor(color.R, color.G, color.B);
-        totalWattage += getWatts(rgb);
-        strip1->SetPixelColor(i, rgb);
+        channelSum += getChannelSum(rgb);
+        strip->SetPixelColor(i, rgb);
       }
+      outputFrameHashPixel(color.R, color.G, color.B, color.W);
     }
-    strip1->Show();
+  }
+  totalWattage = outputWattsFromChannelSum(channelSum);
 
-    // For the second strip (if present)
-    if (pixelCount2 > 0 && strip2 != NULL) {
-      for (uint16_t i=0; i<pixelCount2; i++) {
-        RgbwColor color = getNeoPixelColor(pixelCount1+i);
-        if (strip2->SupportsRgbw()) {
-          totalWattage += getWatts(color);
-          strip2->SetPixelColor(i, color);
-        } else {
-          RgbColor rgb = RgbColor(color.R, color.G, color.B);
-          totalWattage += getWatts(rgb);
-          strip2->SetPixelColor(i, rgb);
-        }
-      }
-      strip2->Show();
-    }
+  // Identical frames keep the previous wire data unless a refresh is due.
+  if (!commitOutputFrame(outputRefreshMs)) {
+    return;
+  }
+  // Show() only queues DMA; on parallel transports the bus starts once every
+  // lane has been shown, so wire time follows the longest strip.
+  for (uint8_t s = 0; s < OUTPUT_MAX_STRIPS && strips[s] != NULL; s++) {
+    strips[s]->Show();
   }
 }
@@ -86,7 +86,34 @@ void parseParams(EmitParams &p, const OscMessage &m) {
   }
 }
 
+// Records the message for host replay. Arguments are stored in the types the
+// handlers read them as: `paramStride` > 0 marks (param, value) groups whose
+// P_SPEED values are floats; everything else is an integer. /command is not
+// recorded here because doCommand() traces each command character itself.
+void traceOscMessage(const char* address, const OscMessage& m, uint8_t paramStride = 0) {
+  #if defined(TRACE_ENABLED) && defined(SPIFFS_ENABLED)
+  if (!traceBeginRecord(TRACE_RECORD_OSC)) {
+    return;
+  }
+  tracePutString8(address);
+  tracePutU8(m.size());
+  for (uint8_t i=0; i<m.size(); i++) {
+    const bool isValue = paramStride > 0 && i % paramStride == paramStride - 1;
+    if (isValue && static_cast<EmitParam>(m.arg<uint8_t>(i - 1)) == P_SPEED) {
+      tracePutU8('f');
+      tracePutF32(m.arg<float>(i));
+    }
+    else {
+      tracePutU8('i');
+      tracePutI32(m.arg<int32_t>(i));
+    }
+  }
+  traceCommitRecord();
+  #endif
+}
+
 void onCommand(const OscMessage& m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
   String command = m.arg<String>(0);
   for (uint8_t i=0; i<command.length(); i++) {
     doCommand(command.charAt(i));
@@ -94,12 +121,16 @@ void onCommand(const OscMessage& m) {
 }
 
 void onEmit(const OscMessage& m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/emit", m, 2);
   EmitParams params;
   parseParams(params, m);
   doEmit(params);
 }
 
 void onNoteOn(const OscMessage& m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/note_on", m, 2);
   EmitParams params;
   params.duration = INFINITE_DURATION;
   parseParams(params, m);
@@ -107,6 +138,9 @@ void onNoteOn(const OscMessage& m) {
 }
 
 void onNoteOff(const OscMessage& m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/note_off", m);
+  markOutputDirty();
   if (m.size() > 0) {
     uint16_t noteId = m.arg<uint16_t>(0);
     state->stopNote(noteId);
@@ -117,6 +151,8 @@ void onNoteOff(const OscMessage& m) {
 }
 
 void onNotesSet(const OscMessage& m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/notes_set", m, 3);
   EmitParams notesSet[MAX_NOTES_SET] = {};
   for (uint8_t i=0; i<m.size() / 3; i++) {
     uint16_t noteId = m.arg<uint16_t>(i*3);
@@ -143,12 +179,18 @@ void onNotesSet(const OscMessage& m) {
 }
 
 void onPalette(const OscMessage& m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/palette", m);
+  markOutputDirty();
   if (m.size() > 0) {
     state->currentPalette = m.arg<uint8_t>(0);
   }
 }
 
 void onColor(const OscMessage &m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/color", m);
+  markOutputDirty();
   if (m.size() > 0) {
     uint8_t i = m.arg<uint8_t>(0);
 
@@ -185,6 +227,9 @@ void onColor(const OscMessage &m) {
 }
 
 void onSplit(const OscMessage &m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/split", m);
+  markOutputDirty();
   if (m.size() > 0) {
     uint8_t i = m.arg<uint8_t>(0);
     state->lightLists[i]->split();
@@ -195,6 +240,9 @@ void onSplit(const OscMessage &m) {
 }
 
 void onAuto(const OscMessage &m) {
+  AllocScope allocScope(ALLOC_PHASE_OSC);
+  traceOscMessage("/auto", m);
+  markOutputDirty();
   state->autoEnabled = !state->autoEnabled;
   emitterEnabled = state->autoEnabled;
 }
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+
+// Output-stage idle detection. The LED loop composes every pixel and retransmits
+// it with Show() each iteration; on ambient installs the frame is usually static.
+// The gate keeps a cheap hash of the last composed frame and a signature of the
+// inputs that can change it, so drawLEDs() can skip compositing and wire output
+// while nothing moves. outputRefreshMs forces a periodic re-show to recover from
+// line glitches (0 disables it).
+
+constexpr unsigned long OUTPUT_IDLE_SETTLE_MS = 500;
+constexpr uint32_t OUTPUT_HASH_SEED = 2166136261u;
+constexpr uint32_t OUTPUT_HASH_PRIME = 16777619u;
+
+inline uint32_t gOutputDirtyEpoch = 0;
+inline bool gOutputForceShow = true;
+inline uint32_t gOutputSignature = 0;
+inline uint32_t gOutputFrameHash = OUTPUT_HASH_SEED;
+inline uint32_t gOutputLastFrameHash = 0;
+inline unsigned long gOutputStableSince = 0;
+inline unsigned long gOutputLastShowAt = 0;
+
+inline uint32_t gOutputFramesComposed = 0;
+inline uint32_t gOutputFramesSkipped = 0;
+inline uint32_t gOutputShowsSkipped = 0;
+
+// Power estimate: 0.2 W per fully lit channel. Channel values are summed as
+// integers per frame and scaled once, so FPU-less targets (ESP32-C3) avoid a
+// soft-float divide per pixel.
+constexpr float OUTPUT_WATTS_PER_CHANNEL = 0.2f;
+
+inline float outputWattsFromChannelSum(uint32_t channelSum) {
+  return static_cast<float>(channelSum) * (OUTPUT_WATTS_PER_CHANNEL / 255.f);
+}
+
+inline uint32_t outputHashMix(uint32_t hash, uint32_t value) {
+  return (hash ^ value) * OUTPUT_HASH_PRIME;
+}
+
+// Call after anything that can change the composed frame without moving lights
+// (palette, layer, brightness or topology edits).
+inline void markOutputDirty() {
+  gOutputDirtyEpoch++;
+  gOutputForceShow = true;
+  gOutputStableSince = millis();
+}
+
+inline void beginOutputFrame() {
+  gOutputFrameHash = OUTPUT_HASH_SEED;
+  gOutputFramesComposed++;
+}
+
+inline void outputFrameHashPixel(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) {
+  gOutputFrameHash = outputHashMix(gOutputFrameHash,
+                                   (static_cast<uint32_t>(r) << 24) |
+                                   (static_cast<uint32_t>(g) << 16) |
+                                   (static_cast<uint32_t>(b) << 8) |
+                                   static_cast<uint32_t>(w));
+}
+
+inline bool isOutputRefreshDue(uint16_t refreshMs, unsigned long now) {
+  return refreshMs > 0 && now - gOutputLastShowAt >= refreshMs;
+}
+
+// Returns true when the composed frame must be sent to the strips.
+inline bool commitOutputFrame(uint16_t refreshMs) {
+  const unsigned long now = millis();
+  const bool changed = gOutputFrameHash != gOutputLastFrameHash;
+  if (changed) {
+    gOutputLastFrameHash = gOutputFrameHash;
+    gOutputStableSince = now;
+  }
+
+  if (!changed && !gOutputForceShow && !isOutputRefreshDue(refreshMs, now)) {
+    gOutputShowsSkipped++;
+    return false;
+  }
+
+  gOutputForceShow = false;
+  gOutputLastShowAt = now;
+  return true;
+}
+
+// Returns true when the frame has to be composed; `staticInputs` reports that no
+// emitted lights or moving layers exist and `signature` folds the remaining inputs.
+inline bool shouldComposeOutputFrame(bool staticInputs, uint32_t signature, uint16_t refreshMs) {
+  const unsigned long now = millis();
+  if (signature != gOutputSignature) {
+    gOutputSignature = signature;
+    gOutputForceShow = true;
+    gOutputStableSince = now;
+    return true;
+  }
+  if (!staticInputs || gOutputForceShow) {
+    return true;
+  }
+  if (now - gOutputStableSince < OUTPUT_IDLE_SETTLE_MS || isOutputRefreshDue(refreshMs, now)) {
+    return true;
+  }
+  gOutputFramesSkipped++;
+  return false;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+
+// Output map: which span of the logical frame goes to which strip. Strips are
+// laid out back to back in config order (strip 1 first); strips with no pixels
+// are skipped. Each strip has its own pin and can override the global LED type
+// and colour order. The LED backends walk the map instead of special-casing
+// strip 1 and strip 2, and use parallel transports (ESP32 I2S x8, S3 LCD x8)
+// when there are more strips than independent output peripherals.
+
+#ifndef OUTPUT_MAX_STRIPS
+#define OUTPUT_MAX_STRIPS 8
+#endif
+
+constexpr uint8_t OUTPUT_INHERIT = 0xFF;
+constexpr uint32_t OUTPUT_MAX_PIXELS = 65535;
+
+struct OutputStripConfig {
+  uint16_t pixelCount = 0;
+  uint8_t pin = 0;
+  uint8_t ledType = OUTPUT_INHERIT;
+  uint8_t colorOrder = OUTPUT_INHERIT;
+};
+
+struct OutputStrip {
+  uint8_t configIndex = 0;
+  uint16_t start = 0;
+  uint16_t count = 0;
+  uint8_t pin = 0;
+  uint8_t ledType = 0;
+  uint8_t colorOrder = 0;
+};
+
+struct OutputMap {
+  OutputStrip strips[OUTPUT_MAX_STRIPS];
+  uint8_t stripCount = 0;
+  uint16_t totalPixels = 0;
+  uint16_t longestStrip = 0;
+  // Set when the configured strips add up to more pixels than a frame can address.
+  bool truncated = false;
+  // Configured strips left out because the backend drives fewer than OUTPUT_MAX_STRIPS.
+  uint8_t droppedStrips = 0;
+
+  void build(const OutputStripConfig* configs,
+             uint8_t defaultLedType,
+             uint8_t defaultColorOrder,
+             uint8_t maxStrips = OUTPUT_MAX_STRIPS) {
+    stripCount = 0;
+    totalPixels = 0;
+    longestStrip = 0;
+    truncated = false;
+    droppedStrips = 0;
+
+    uint32_t start = 0;
+    for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+      const OutputStripConfig& config = configs[i];
+      if (config.pixelCount == 0) {
+        continue;
+      }
+      if (stripCount >= maxStrips) {
+        droppedStrips++;
+        continue;
+      }
+      uint32_t count = config.pixelCount;
+      if (start + count > OUTPUT_MAX_PIXELS) {
+        count = OUTPUT_MAX_PIXELS - start;
+        truncated = true;
+      }
+      if (count == 0) {
+        continue;
+      }
+
+      OutputStrip& strip = strips[stripCount++];
+      strip.configIndex = i;
+      strip.start = static_cast<uint16_t>(start);
+      strip.count = static_cast<uint16_t>(count);
+      strip.pin = config.pin;
+      strip.ledType = config.ledType == OUTPUT_INHERIT ? defaultLedType : config.ledType;
+      strip.colorOrder = config.colorOrder == OUTPUT_INHERIT ? defaultColorOrder : config.colorOrder;
+      if (strip.count > longestStrip) {
+        longestStrip = strip.count;
+      }
+      start += count;
+    }
+    totalPixels = static_cast<uint16_t>(start);
+  }
+
+  // Index into `strips` for a logical pixel, or -1 past the end of the frame.
+  int8_t locate(uint16_t pixel, uint16_t& localIndex) const {
+    for (uint8_t i = 0; i < stripCount; i++) {
+      const OutputStrip& strip = strips[i];
+      if (pixel < strip.start + strip.count) {
+        localIndex = pixel - strip.start;
+        return static_cast<int8_t>(i);
+      }
+    }
+    return -1;
+  }
+
+  bool hasMixedLedTypes() const {
+    for (uint8_t i = 1; i < stripCount; i++) {
+      if (strips[i].ledType != strips[0].ledType) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <Arduino.h>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+// Compact binary encoding of TopologySnapshot for /export_topology and
+// /import_topology (Content-Type / Accept: application/vnd.meshled.topology).
+// JSON stays the default for the control panel and for humans.
+//
+// Layout (little endian):
+//   header  "MLTP" u8 formatVersion, u8 schemaVersion, u16 pixelCount
+//   records u8 tag followed by a fixed-size payload:
+//     'I' intersection  u16 id, numPorts, u16 topPixel, i16 bottomPixel, group
+//     'C' connection    u16 fromIntersectionId, u16 toIntersectionId, group, u16 numLeds
+//     'P' port          u16 id, u16 intersectionId, slotIndex, type, direction, group, mac[6],
+//                       u16 targetPortId
+//     'M' model         id, defaultWeight, emitGroups, u16 maxLength, routingStrategy
+//     'W' weight        u16 outgoingPortId, defaultWeight        (belongs to the last 'M')
+//     'K' conditional   u16 incomingPortId, weight               (belongs to the last 'W')
+//     'G' gap           u16 fromPixel, u16 toPixel
+//     'E' end           u32 CRC-32 of every byte before this record
+//
+// Intersection and port ids are u16 on the wire so the format does not change
+// when the core ids widen. The decoder rejects ids that do not fit the
+// snapshot's id types, so today anything above 255 fails the import instead of
+// wrapping.
+//
+// The decoder is fed the body in chunks as it arrives and validates each record
+// when it completes, so only one record is buffered at a time.
+
+#define TOPOLOGY_BINARY_CONTENT_TYPE "application/vnd.meshled.topology"
+
+constexpr uint8_t TOPOLOGY_BINARY_FORMAT_VERSION = 1;
+constexpr uint8_t TOPOLOGY_BINARY_HEADER_SIZE = 8;
+constexpr uint8_t TOPOLOGY_BINARY_MAX_RECORD = 16;
+
+// Id types of the core's topology snapshot. The HTTP routes, the JSON import and
+// this decoder bound intersection and port ids by these rather than by 255, so
+// they accept wider ids as soon as the core types widen.
+using TopologyIntersectionId = decltype(TopologyIntersectionSnapshot::id);
+using TopologyPortId = decltype(TopologyPortSnapshot::id);
+constexpr long TOPOLOGY_MAX_INTERSECTION_ID = std::numeric_limits<TopologyIntersectionId>::max();
+constexpr long TOPOLOGY_MAX_PORT_ID = std::numeric_limits<TopologyPortId>::max();
+
+inline uint32_t topologyCrc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+inline uint8_t topologyBinaryRecordSize(uint8_t tag) {
+  switch (tag) {
+    case 'I': return 8;
+    case 'C': return 7;
+    case 'P': return 16;
+    case 'M': return 6;
+    case 'W': return 3;
+    case 'K': return 3;
+    case 'G': return 4;
+    case 'E': return 4;
+  }
+  return 0;
+}
+
+inline size_t topologyBinarySize(const TopologySnapshot& snapshot) {
+  size_t size = TOPOLOGY_BINARY_HEADER_SIZE;
+  size += snapshot.intersections.size() * (1 + topologyBinaryRecordSize('I'));
+  size += snapshot.connections.size() * (1 + topologyBinaryRecordSize('C'));
+  size += snapshot.ports.size() * (1 + topologyBinaryRecordSize('P'));
+  for (const TopologyModelSnapshot& model : snapshot.models) {
+    size += 1 + topologyBinaryRecordSize('M');
+    for (const TopologyPortWeightSnapshot& weight : model.weights) {
+      size += 1 + topologyBinaryRecordSize('W');
+      size += weight.conditionals.size() * (1 + topologyBinaryRecordSize('K'));
+    }
+  }
+  size += snapshot.gaps.size() * (1 + topologyBinaryRecordSize('G'));
+  size += 1 + topologyBinaryRecordSize('E');
+  return size;
+}
+
+class TopologyBinaryWriter {
+ public:
+  explicit TopologyBinaryWriter(Print& out) : out_(out) {}
+
+  void write(const TopologySnapshot& snapshot) {
+    const uint8_t header[TOPOLOGY_BINARY_HEADER_SIZE] = {
+      'M', 'L', 'T', 'P',
+      TOPOLOGY_BINARY_FORMAT_VERSION,
+      snapshot.schemaVersion,
+      static_cast<uint8_t>(snapshot.pixelCount & 0xFF),
+      static_cast<uint8_t>(snapshot.pixelCount >> 8),
+    };
+    emit(header, sizeof(header));
+
+    for (const TopologyIntersectionSnapshot& intersection : snapshot.intersections) {
+      const uint16_t bottomPixel = static_cast<uint16_t>(intersection.bottomPixel);
+      const uint8_t record[] = {
+        'I', lo(intersection.id), hi(intersection.id), intersection.numPorts,
+        lo(intersection.topPixel), hi(intersection.topPixel),
+        lo(bottomPixel), hi(bottomPixel),
+        intersection.group,
+      };
+      emit(record, sizeof(record));
+    }
+
+    for (const TopologyConnectionSnapshot& connection : snapshot.connections) {
+      const uint8_t record[] = {
+        'C', lo(connection.fromIntersectionId), hi(connection.fromIntersectionId),
+        lo(connection.toIntersectionId), hi(connection.toIntersectionId), connection.group,
+        lo(connection.numLeds), hi(connection.numLeds),
+      };
+      emit(record, sizeof(record));
+    }
+
+    for (const TopologyPortSnapshot& port : snapshot.ports) {
+      const uint8_t record[] = {
+        'P', lo(port.id), hi(port.id), lo(port.intersectionId), hi(port.intersectionId), port.slotIndex,
+        static_cast<uint8_t>(port.type == TopologyPortType::External ? 1 : 0),
+        static_cast<uint8_t>(port.direction ? 1 : 0),
+        port.group,
+        port.deviceMac[0], port.deviceMac[1], port.deviceMac[2],
+        port.deviceMac[3], port.deviceMac[4], port.deviceMac[5],
+        lo(port.targetPortId), hi(port.targetPortId),
+      };
+      emit(record, sizeof(record));
+    }
+
+    for (const TopologyModelSnapshot& model : snapshot.models) {
+      const uint8_t record[] = {
+        'M', model.id, model.defaultWeight, model.emitGroups,
+        lo(model.maxLength), hi(model.maxLength),
+        static_cast<uint8_t>(model.routingStrategy),
+      };
+      emit(record, sizeof(record));
+      for (const TopologyPortWeightSnapshot& weight : model.weights) {
+        const uint8_t weightRecord[] = {'W', lo(weight.outgoingPortId), hi(weight.outgoingPortId),
+                                        weight.defaultWeight};
+        emit(weightRecord, sizeof(weightRecord));
+        for (const TopologyWeightConditionalSnapshot& conditional : weight.conditionals) {
+          const uint8_t conditionalRecord[] = {'K', lo(conditional.incomingPortId), hi(conditional.incomingPortId),
+                                               conditional.weight};
+          emit(conditionalRecord, sizeof(conditionalRecord));
+        }
+      }
+    }
+
+    for (const PixelGap& gap : snapshot.gaps) {
+      const uint8_t record[] = {'G', lo(gap.fromPixel), hi(gap.fromPixel), lo(gap.toPixel), hi(gap.toPixel)};
+      emit(record, sizeof(record));
+    }
+
+    const uint32_t crc = crc_;
+    const uint8_t end[] = {
+      'E',
+      static_cast<uint8_t>(crc & 0xFF),
+      static_cast<uint8_t>((crc >> 8) & 0xFF),
+      static_cast<uint8_t>((crc >> 16) & 0xFF),
+      static_cast<uint8_t>((crc >> 24) & 0xFF),
+    };
+    out_.write(end, sizeof(end));
+  }
+
+ private:
+  static uint8_t lo(uint16_t value) { return static_cast<uint8_t>(value & 0xFF); }
+  static uint8_t hi(uint16_t value) { return static_cast<uint8_t>(value >> 8); }
+
+  void emit(const uint8_t* data, size_t length) {
+    crc_ = topologyCrc32Update(crc_, data, length);
+    out_.write(data, length);
+  }
+
+  Print& out_;
+  uint32_t crc_ = 0;
+};
+
+class TopologyBinaryDecoder {
+ public:
+  void reset() {
+    snapshot = TopologySnapshot();
+    error_ = "";
+    crc_ = 0;
+    received_ = 0;
+    filled_ = 0;
+    tag_ = 0;
+    headerDone_ = false;
+    finished_ = false;
+  }
+
+  // Consumes the next chunk of the body. Returns false once the stream is invalid.
+  bool feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      if (!consume(data[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool finished() const { return finished_ && error_.length() == 0; }
+  bool failed() const { return error_.length() > 0; }
+  const String& error() const { return error_; }
+  size_t received() const { return received_; }
+
+  TopologySnapshot snapshot;
+
+ private:
+  bool fail(const char* message) {
+    if (error_.length() == 0) {
+      error_ = message;
+    }
+    return false;
+  }
+
+  uint16_t u16(uint8_t offset) const {
+    return static_cast<uint16_t>(buffer_[offset] | (buffer_[offset + 1] << 8));
+  }
+
+  // True when the u16 at `offset` fits the snapshot's id type.
+  template <typename Id>
+  bool fits(uint8_t offset) const {
+    return u16(offset) <= std::numeric_limits<Id>::max();
+  }
+
+  bool consume(uint8_t byte) {
+    if (failed()) {
+      return false;
+    }
+    if (finished_) {
+      return fail("Trailing data after end record");
+    }
+    received_++;
+
+    if (!headerDone_) {
+      crc_ = topologyCrc32Update(crc_, &byte, 1);
+      buffer_[filled_++] = byte;
+      if (filled_ < TOPOLOGY_BINARY_HEADER_SIZE) {
+        return true;
+      }
+      filled_ = 0;
+      headerDone_ = true;
+      return parseHeader();
+    }
+
+    if (tag_ == 0) {
+      if (topologyBinaryRecordSize(byte) == 0) {
+        return fail("Unknown record tag");
+      }
+      tag_ = byte;
+      if (tag_ != 'E') {
+        crc_ = topologyCrc32Update(crc_, &byte, 1);
+      }
+      return true;
+    }
+
+    if (tag_ != 'E') {
+      crc_ = topologyCrc32Update(crc_, &byte, 1);
+    }
+    buffer_[filled_++] = byte;
+    if (filled_ < topologyBinaryRecordSize(tag_)) {
+      return true;
+    }
+
+    const uint8_t tag = tag_;
+    tag_ = 0;
+    filled_ = 0;
+    return parseRecord(tag);
+  }
+
+  bool parseHeader() {
+    if (buffer_[0] != 'M' || buffer_[1] != 'L' || buffer_[2] != 'T' || buffer_[3] != 'P') {
+      return fail("Not a binary topology snapshot");
+    }
+    if (buffer_[4] != TOPOLOGY_BINARY_FORMAT_VERSION) {
+      return fail("Unsupported binary topology format version");
+    }
+    if (buffer_[5] != 2) {
+      return fail("Unsupported schemaVersion; expected 2");
+    }
+    snapshot.schemaVersion = buffer_[5];
+    snapshot.pixelCount = u16(6);
+    if (snapshot.pixelCount == 0) {
+      return fail("Invalid or missing pixelCount");
+    }
+    return true;
+  }
+
+  bool parseRecord(uint8_t tag) {
+    switch (tag) {
+      case 'I': {
+        const int16_t bottomPixel = static_cast<int16_t>(u16(5));
+        if (!fits<TopologyIntersectionId>(0) || buffer_[2] < 1 || buffer_[2] > 8 || buffer_[7] == 0 || bottomPixel < -1) {
+          return fail("Invalid intersection entry");
+        }
+        snapshot.intersections.push_back(
+            {static_cast<TopologyIntersectionId>(u16(0)), buffer_[2], u16(3), bottomPixel, buffer_[7]});
+        return true;
+      }
+      case 'C':
+        if (!fits<TopologyIntersectionId>(0) || !fits<TopologyIntersectionId>(2) || buffer_[4] == 0) {
+          return fail("Invalid connection entry");
+        }
+        snapshot.connections.push_back(
+            {static_cast<TopologyIntersectionId>(u16(0)), static_cast<TopologyIntersectionId>(u16(2)), buffer_[4], u16(5)});
+        return true;
+      case 'P': {
+        if (!fits<TopologyPortId>(0) || !fits<TopologyIntersectionId>(2) || !fits<TopologyPortId>(14) || buffer_[5] > 1 ||
+            buffer_[7] == 0) {
+          return fail("Invalid port entry");
+        }
+        const TopologyPortType type = buffer_[5] == 1 ? TopologyPortType::External : TopologyPortType::Internal;
+        std::array<uint8_t, 6> deviceMac = {buffer_[8], buffer_[9], buffer_[10], buffer_[11], buffer_[12], buffer_[13]};
+        snapshot.ports.push_back({static_cast<TopologyPortId>(u16(0)), static_cast<TopologyIntersectionId>(u16(2)), buffer_[4], type,
+                                  buffer_[6] != 0, buffer_[7], deviceMac, static_cast<TopologyPortId>(u16(14))});
+        return true;
+      }
+      case 'M':
+        if (buffer_[5] > 1) {
+          return fail("Invalid model routingStrategy");
+        }
+        snapshot.models.push_back({buffer_[0], buffer_[1], buffer_[2], u16(3),
+                                   static_cast<RoutingStrategy>(buffer_[5]), {}});
+        return true;
+      case 'W':
+        if (snapshot.models.empty() || !fits<TopologyPortId>(0)) {
+          return fail("Invalid model weight entry");
+        }
+        snapshot.models.back().weights.push_back({static_cast<TopologyPortId>(u16(0)), buffer_[2], {}});
+        return true;
+      case 'K':
+        if (snapshot.models.empty() || snapshot.models.back().weights.empty() || !fits<TopologyPortId>(0)) {
+          return fail("Invalid conditional model weight entry");
+        }
+        snapshot.models.back().weights.back().conditionals.push_back({static_cast<TopologyPortId>(u16(0)), buffer_[2]});
+        return true;
+      case 'G':
+        snapshot.gaps.push_back({u16(0), u16(2)});
+        return true;
+      case 'E': {
+        const uint32_t expected = static_cast<uint32_t>(buffer_[0]) |
+                                  (static_cast<uint32_t>(buffer_[1]) << 8) |
+                                  (static_cast<uint32_t>(buffer_[2]) << 16) |
+                                  (static_cast<uint32_t>(buffer_[3]) << 24);
+        if (expected != crc_) {
+          return fail("Checksum mismatch");
+        }
+        finished_ = true;
+        return true;
+      }
+    }
+    return fail("Unknown record tag");
+  }
+
+  uint8_t buffer_[TOPOLOGY_BINARY_MAX_RECORD] = {};
+  uint8_t filled_ = 0;
+  uint8_t tag_ = 0;
+  uint32_t crc_ = 0;
+  size_t received_ = 0;
+  bool headerDone_ = false;
+  bool finished_ = false;
+  String error_;
+};
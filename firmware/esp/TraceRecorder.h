@@ -0,0 +1,245 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+
+// Input trace recorder. While a trace is running, every OSC message, mutating
+// HTTP request and command is recorded with its offset from the start of the
+// recording, so the same workload can be replayed on the host simulator
+// (MESHLED_TRACE=/path/to/trace.bin) to compare frame-time and memory between
+// builds. Handlers only append to a RAM buffer; flushTrace() writes it to
+// TRACE_FILE from the main loop, so no SPIFFS write happens inside a handler.
+//
+// Layout (little endian):
+//   header  "MLTR" u8 version, u8 objectType, u16 pixelCount, u32 randomSeed, u32 startMillis
+//   record  u8 type, u32 offsetMs, u16 payloadLength, payload
+//   OSC     u8 addressLength, address, u8 argCount, argCount x (u8 tag 'i'|'f', 4 bytes)
+//   HTTP    u8 uriLength, uri, u16 argsLength, url-encoded args
+//   command u8 command
+
+#define TRACE_FILE "/trace.bin"
+#ifndef TRACE_MAX_BYTES
+#define TRACE_MAX_BYTES 262144
+#endif
+
+#ifndef TRACE_BUFFER_BYTES
+#define TRACE_BUFFER_BYTES 4096
+#endif
+
+constexpr uint8_t TRACE_VERSION = 1;
+constexpr uint16_t TRACE_RECORD_MAX_PAYLOAD = 512;
+
+enum TraceRecordType : uint8_t {
+  TRACE_RECORD_OSC = 1,
+  TRACE_RECORD_HTTP = 2,
+  TRACE_RECORD_COMMAND = 3,
+};
+
+#if defined(TRACE_ENABLED) && defined(SPIFFS_ENABLED)
+
+inline File gTraceFile;
+inline bool gTraceActive = false;
+inline uint32_t gTraceSeed = 0;
+inline unsigned long gTraceStartedAt = 0;
+inline uint8_t gTraceBuffer[TRACE_BUFFER_BYTES];
+inline uint16_t gTraceBufferLength = 0;
+inline uint32_t gTraceBytes = 0;
+inline uint32_t gTraceRecords = 0;
+inline uint32_t gTraceDropped = 0;
+
+inline uint8_t gTracePayload[TRACE_RECORD_MAX_PAYLOAD];
+inline uint16_t gTracePayloadLength = 0;
+inline bool gTracePayloadOverflow = false;
+inline TraceRecordType gTracePayloadType = TRACE_RECORD_OSC;
+
+inline bool isTraceActive() {
+  return gTraceActive;
+}
+
+inline void tracePutBytes(const void* data, uint16_t length) {
+  if (gTracePayloadOverflow || gTracePayloadLength + length > TRACE_RECORD_MAX_PAYLOAD) {
+    gTracePayloadOverflow = true;
+    return;
+  }
+  memcpy(gTracePayload + gTracePayloadLength, data, length);
+  gTracePayloadLength += length;
+}
+
+inline void tracePutU8(uint8_t value) {
+  tracePutBytes(&value, sizeof(value));
+}
+
+inline void tracePutU16(uint16_t value) {
+  tracePutBytes(&value, sizeof(value));
+}
+
+inline void tracePutI32(int32_t value) {
+  tracePutBytes(&value, sizeof(value));
+}
+
+inline void tracePutF32(float value) {
+  tracePutBytes(&value, sizeof(value));
+}
+
+inline void tracePutString8(const char* value) {
+  const size_t valueLength = strlen(value);
+  const uint8_t length = valueLength > 255 ? 255 : valueLength;
+  tracePutU8(length);
+  tracePutBytes(value, length);
+}
+
+inline void traceBufferBytes(const void* data, uint16_t length) {
+  memcpy(gTraceBuffer + gTraceBufferLength, data, length);
+  gTraceBufferLength += length;
+}
+
+// Writes buffered records to TRACE_FILE. Called from the main loop.
+inline void flushTrace() {
+  if (gTraceBufferLength == 0 || !gTraceFile) {
+    return;
+  }
+  gTraceFile.write(gTraceBuffer, gTraceBufferLength);
+  gTraceBufferLength = 0;
+}
+
+inline bool traceBeginRecord(TraceRecordType type) {
+  if (!gTraceActive) {
+    return false;
+  }
+  gTracePayloadType = type;
+  gTracePayloadLength = 0;
+  gTracePayloadOverflow = false;
+  return true;
+}
+
+inline void traceCommitRecord() {
+  if (!gTraceActive) {
+    return;
+  }
+  const uint32_t recordBytes = 1 + 4 + 2 + gTracePayloadLength;
+  // Records that do not fit until the next flush are dropped, not written inline.
+  if (gTracePayloadOverflow || gTraceBytes + recordBytes > TRACE_MAX_BYTES ||
+      gTraceBufferLength + recordBytes > TRACE_BUFFER_BYTES) {
+    gTraceDropped++;
+    return;
+  }
+  const uint8_t type = gTracePayloadType;
+  const uint32_t offsetMs = millis() - gTraceStartedAt;
+  traceBufferBytes(&type, sizeof(type));
+  traceBufferBytes(&offsetMs, sizeof(offsetMs));
+  traceBufferBytes(&gTracePayloadLength, sizeof(gTracePayloadLength));
+  traceBufferBytes(gTracePayload, gTracePayloadLength);
+  gTraceBytes += recordBytes;
+  gTraceRecords++;
+}
+
+// Starts a new recording, replacing any previous trace. The random generator is
+// reseeded so the host replay can reproduce the same auto-emitter choices.
+inline bool startTrace(uint8_t objectType, uint16_t pixelCount) {
+  if (gTraceActive) {
+    return true;
+  }
+  gTraceFile = SPIFFS.open(TRACE_FILE, FILE_WRITE);
+  if (!gTraceFile) {
+    LP_LOGLN("Trace: failed to open " TRACE_FILE);
+    return false;
+  }
+
+  gTraceSeed = esp_random();
+  randomSeed(gTraceSeed);
+  gTraceStartedAt = millis();
+  gTraceBufferLength = 0;
+  gTraceRecords = 0;
+  gTraceDropped = 0;
+
+  const uint32_t startMillis = gTraceStartedAt;
+  traceBufferBytes("MLTR", 4);
+  traceBufferBytes(&TRACE_VERSION, sizeof(TRACE_VERSION));
+  traceBufferBytes(&objectType, sizeof(objectType));
+  traceBufferBytes(&pixelCount, sizeof(pixelCount));
+  traceBufferBytes(&gTraceSeed, sizeof(gTraceSeed));
+  traceBufferBytes(&startMillis, sizeof(startMillis));
+  gTraceBytes = 16;
+  gTraceActive = true;
+
+  LP_LOGF("Trace: recording started (seed %u)\n", gTraceSeed);
+  return true;
+}
+
+inline void stopTrace() {
+  if (!gTraceActive) {
+    return;
+  }
+  gTraceActive = false;
+  flushTrace();
+  gTraceFile.close();
+  LP_LOGF("Trace: recording stopped (%u records, %u bytes, %u dropped)\n",
+          gTraceRecords, gTraceBytes, gTraceDropped);
+}
+
+inline void traceCommand(char command) {
+  if (!traceBeginRecord(TRACE_RECORD_COMMAND)) {
+    return;
+  }
+  tracePutU8(static_cast<uint8_t>(command));
+  traceCommitRecord();
+}
+
+// HTTP records are built in place: traceBeginHttpRequest() writes the uri,
+// traceAppendHttpArg() adds `name=value` pairs (joined with '&') and
+// traceCommitHttpRequest() patches in their u16 length. JSON bodies are
+// recorded as `plain=`. Args that do not fit the payload are truncated.
+inline uint16_t gTraceHttpArgsAt = 0;
+
+inline void traceBeginHttpRequest(const char* uri) {
+  if (!traceBeginRecord(TRACE_RECORD_HTTP)) {
+    return;
+  }
+  tracePutString8(uri);
+  gTraceHttpArgsAt = gTracePayloadLength;
+  tracePutU16(0);
+}
+
+inline void traceAppendHttpArgBytes(const char* data, size_t length) {
+  const uint16_t room = TRACE_RECORD_MAX_PAYLOAD - gTracePayloadLength;
+  tracePutBytes(data, length > room ? room : length);
+}
+
+inline void traceAppendHttpArg(const char* name, const char* value) {
+  if (!gTraceActive || gTracePayloadOverflow) {
+    return;
+  }
+  if (gTracePayloadLength > gTraceHttpArgsAt + 2) {
+    traceAppendHttpArgBytes("&", 1);
+  }
+  traceAppendHttpArgBytes(name, strlen(name));
+  traceAppendHttpArgBytes("=", 1);
+  traceAppendHttpArgBytes(value, strlen(value));
+}
+
+inline void traceCommitHttpRequest() {
+  if (!gTraceActive || gTracePayloadOverflow) {
+    return;
+  }
+  const uint16_t argsLength = gTracePayloadLength - gTraceHttpArgsAt - 2;
+  memcpy(gTracePayload + gTraceHttpArgsAt, &argsLength, sizeof(argsLength));
+  traceCommitRecord();
+}
+
+#else
+
+inline bool isTraceActive() {
+  return false;
+}
+
+inline void traceCommand(char) {}
+
+inline void flushTrace() {}
+
+inline void traceBeginHttpRequest(const char*) {}
+
+inline void traceAppendHttpArg(const char*, const char*) {}
+
+inline void traceCommitHttpRequest() {}
+
+#endif
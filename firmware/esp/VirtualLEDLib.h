@@ -0,0 +1,115 @@
+#pragma once
+
+// Bit rate, channel depth and latch time per LED type, as the NeoPixelBus and
+// FastLED methods drive them. Used only to model wire time.
+VirtualStripTiming virtualLedTiming(uint8_t ledType) {
+  VirtualStripTiming timing;
+  switch (ledType) {
+    case LED_WS2811:
+    case LED_WS2811_400:
+    case LED_GW6205_400:
+    case LED_TM1803:
+    case LED_UCS1903:
+      timing.bitRateHz = 400000;
+      timing.resetMicros = 50;
+      break;
+    case LED_APA106:
+      timing.bitRateHz = 585000;
+      timing.resetMicros = 50;
+      break;
+    case LED_WS2816:
+      timing.bitsPerChannel = 16;
+      break;
+    case LED_LPD1886:
+      timing.bitsPerChannel = 12;
+      break;
+    case LED_SK6812:
+    case LED_SK6822:
+      timing.resetMicros = 80;
+      break;
+    case LED_TM1829:
+      timing.resetMicros = 500;
+      break;
+    case LED_TM1814:
+    case LED_TM1914:
+      timing.resetMicros = 200;
+      break;
+    case LED_WS2812:
+    case LED_WS2815:
+    case LED_WS2813:
+    case LED_WS2814:
+    default:
+      break;
+  }
+  return timing;
+}
+
+void setupVirtualLEDs() {
+  if (ledLibrary != LIB_VIRTUAL) {
+    virtualOutput.configure(OutputMap(), NULL);
+    return;
+  }
+
+  VirtualStripTiming timings[OUTPUT_MAX_STRIPS];
+  for (uint8_t i = 0; i < outputMap.stripCount; i++) {
+    timings[i] = virtualLedTiming(outputMap.strips[i].ledType);
+  }
+  virtualOutput.configure(outputMap, timings);
+
+  LP_LOGLN("Virtual LEDs initialized with " + String(outputMap.stripCount) + " strip(s), " +
+           String(virtualOutput.frameBytes()) + " bytes/frame, " +
+           String(virtualOutput.frameMicros()) + " us/frame");
+}
+
+VirtualColor getVirtualLEDColor(uint16_t i, uint8_t order = colorOrder) {
+  const uint8_t effectiveBrightness = wledMasterOn ? maxBrightness : 0;
+  ColorRGB pixel = state->getPixel(state->object.translateToLogicalPixel(i), effectiveBrightness);
+  VirtualColor color;
+  color.r = pixel.R;
+  color.g = pixel.G;
+  color.b = pixel.B;
+  if (HAS_WHITE(order)) {
+    const uint8_t minRGB = min(color.r, min(color.g, color.b));
+    color.r -= minRGB;
+    color.g -= minRGB;
+    color.b -= minRGB;
+    color.w = minRGB;
+  }
+  return color;
+}
+
+// micros() wraps after ~71 minutes; the transfer model needs a monotonic clock.
+uint64_t virtualClockMicros() {
+  static uint32_t lastMicros = 0;
+  static uint64_t wraps = 0;
+  const uint32_t now = micros();
+  if (now < lastMicros) {
+    wraps += 1ULL << 32;
+  }
+  lastMicros = now;
+  return wraps + now;
+}
+
+void drawVirtualLEDs() {
+  if (ledLibrary != LIB_VIRTUAL || virtualOutput.stripCount() == 0) {
+    return;
+  }
+
+  uint32_t channelSum = 0;
+  for (uint8_t s = 0; s < virtualOutput.stripCount(); s++) {
+    const VirtualStripFrame& strip = virtualOutput.strip(s);
+    for (uint16_t i = 0; i < strip.count; i++) {
+      const VirtualColor color = getVirtualLEDColor(strip.start + i, strip.colorOrder);
+      channelSum += color.r + color.g + color.b + color.w;
+      virtualOutput.setPixel(s, i, color.r, color.g, color.b, color.w);
+      outputFrameHashPixel(color.r, color.g, color.b, color.w);
+    }
+  }
+  totalWattage = outputWattsFromChannelSum(channelSum);
+
+  // Identical frames keep the previous wire data unless a refresh is due.
+  if (!commitOutputFrame(outputRefreshMs)) {
+    return;
+  }
+  virtualOutput.show(virtualClockMicros());
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ColorOrder.h"
+#include "OutputMap.h"
+
+#if !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#define VIRTUAL_OUTPUT_SOCKET_SUPPORTED
+#endif
+
+// Virtual LED output: captures each shown frame into memory, in the byte order
+// the strips would receive it, and models how long the wire transfer takes from
+// the protocol bit rate. It has no Arduino dependency so host builds can drive
+// the output path (power limiting, colour order, frame gating) without a strip.
+//
+// Strips are modelled as independent channels shifting out together, like the
+// I2S/RMT/parallel transports, so a frame takes as long as its slowest strip.
+// Show() on real drivers waits for the previous transfer; show() reports that
+// wait instead of sleeping.
+
+struct VirtualStripTiming {
+  uint32_t bitRateHz = 800000;
+  uint8_t bitsPerChannel = 8;
+  uint16_t resetMicros = 300;
+};
+
+struct VirtualColor {
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+  uint8_t w = 0;
+};
+
+struct VirtualStripFrame {
+  uint32_t byteOffset = 0;
+  uint16_t start = 0;
+  uint16_t count = 0;
+  uint8_t colorOrder = CO_GRB;
+  uint8_t bytesPerPixel = 3;
+  uint32_t wireMicros = 0;
+};
+
+class VirtualOutput {
+ public:
+  void configure(const OutputMap& map, const VirtualStripTiming* timings) {
+    stripCount_ = map.stripCount;
+    frameMicros_ = 0;
+    uint32_t bytes = 0;
+    for (uint8_t i = 0; i < stripCount_; i++) {
+      const OutputStrip& output = map.strips[i];
+      VirtualStripFrame& strip = strips_[i];
+      strip.byteOffset = bytes;
+      strip.start = output.start;
+      strip.count = output.count;
+      strip.colorOrder = hardwareColorOrder(output.colorOrder);
+      strip.bytesPerPixel = HAS_WHITE(strip.colorOrder) ? 4 : 3;
+      strip.wireMicros = wireMicros(output.count, strip.bytesPerPixel, timings[i]);
+      if (strip.wireMicros > frameMicros_) {
+        frameMicros_ = strip.wireMicros;
+      }
+      bytes += static_cast<uint32_t>(output.count) * strip.bytesPerPixel;
+    }
+    frame_.assign(bytes, 0);
+    reset();
+  }
+
+  void reset() {
+    frames = 0;
+    totalWireMicros = 0;
+    blockedMicros = 0;
+    busyUntilMicros_ = 0;
+  }
+
+  // Wire time for `count` pixels: every channel bit at the protocol bit rate,
+  // plus the latch/reset gap that ends the frame.
+  static uint32_t wireMicros(uint16_t count, uint8_t channels, const VirtualStripTiming& timing) {
+    if (count == 0 || timing.bitRateHz == 0) {
+      return 0;
+    }
+    const uint64_t bits = static_cast<uint64_t>(count) * channels * timing.bitsPerChannel;
+    return static_cast<uint32_t>((bits * 1000000ULL + timing.bitRateHz - 1) / timing.bitRateHz) +
+           timing.resetMicros;
+  }
+
+  void setPixel(uint8_t stripIndex, uint16_t localIndex, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) {
+    const VirtualStripFrame& strip = strips_[stripIndex];
+    uint8_t* out = &frame_[strip.byteOffset + static_cast<uint32_t>(localIndex) * strip.bytesPerPixel];
+    const uint8_t channels[4] = {r, g, b, w};
+    out[0] = channels[orderSlot(strip.colorOrder, 0)];
+    out[1] = channels[orderSlot(strip.colorOrder, 1)];
+    out[2] = channels[orderSlot(strip.colorOrder, 2)];
+    if (strip.bytesPerPixel == 4) {
+      out[3] = w;
+    }
+  }
+
+  // Undoes the colour order of the captured frame for one logical pixel.
+  bool readPixel(uint16_t pixel, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& w) const {
+    for (uint8_t i = 0; i < stripCount_; i++) {
+      const VirtualStripFrame& strip = strips_[i];
+      if (pixel >= strip.start + strip.count) {
+        continue;
+      }
+      const uint8_t* in = &frame_[strip.byteOffset + static_cast<uint32_t>(pixel - strip.start) * strip.bytesPerPixel];
+      uint8_t channels[4] = {0, 0, 0, 0};
+      channels[orderSlot(strip.colorOrder, 0)] = in[0];
+      channels[orderSlot(strip.colorOrder, 1)] = in[1];
+      channels[orderSlot(strip.colorOrder, 2)] = in[2];
+      r = channels[CO_R];
+      g = channels[CO_G];
+      b = channels[CO_B];
+      w = strip.bytesPerPixel == 4 ? in[3] : 0;
+      return true;
+    }
+    return false;
+  }
+
+  // Order the hardware backends actually send for a configured order. They only
+  // build RGB, GRB, RGBW and GRBW strips (createNeoPixelBusStripWithMethod,
+  // FASTLED_ADD_CHIPSET) and fall back to GRB, so BGR, BRG, RBG and GBR go out
+  // as GRB there and must do so here too.
+  static uint8_t hardwareColorOrder(uint8_t order) {
+    switch (order) {
+      case CO_RGB:
+      case CO_RGBW:
+      case CO_GRBW:
+        return order;
+      default:
+        return CO_GRB;
+    }
+  }
+
+  // Component (CO_R/CO_G/CO_B) sent in wire slot 0..2. In the RGBW encoding
+  // slot 0 shares bit 7 with FLAG_RGBW, so only its low bit is meaningful
+  // (enough for RGBW and GRBW).
+  static uint8_t orderSlot(uint8_t order, uint8_t slot) {
+    if (HAS_WHITE(order)) {
+      const uint8_t component = (order >> (6 - slot * 2)) & 0x3;
+      return slot == 0 ? (component & 0x1) : component;
+    }
+    return (order >> (4 - slot * 2)) & 0x3;
+  }
+
+  // Latches the frame at `nowMicros` and returns how long a real driver would
+  // have blocked waiting for the previous transfer.
+  uint32_t show(uint64_t nowMicros) {
+    uint32_t blocked = 0;
+    uint64_t start = nowMicros;
+    if (busyUntilMicros_ > nowMicros) {
+      blocked = static_cast<uint32_t>(busyUntilMicros_ - nowMicros);
+      start = busyUntilMicros_;
+    }
+    busyUntilMicros_ = start + frameMicros_;
+    blockedMicros += blocked;
+    totalWireMicros += frameMicros_;
+    frames++;
+    return blocked;
+  }
+
+  bool canShow(uint64_t nowMicros) const { return nowMicros >= busyUntilMicros_; }
+
+  const uint8_t* frame() const { return frame_.data(); }
+  size_t frameBytes() const { return frame_.size(); }
+  uint8_t stripCount() const { return stripCount_; }
+  const VirtualStripFrame& strip(uint8_t index) const { return strips_[index]; }
+  uint32_t frameMicros() const { return frameMicros_; }
+
+  uint32_t frames = 0;
+  uint64_t totalWireMicros = 0;
+  uint64_t blockedMicros = 0;
+
+ private:
+  VirtualStripFrame strips_[OUTPUT_MAX_STRIPS];
+  uint8_t stripCount_ = 0;
+  uint32_t frameMicros_ = 0;
+  uint64_t busyUntilMicros_ = 0;
+  std::vector<uint8_t> frame_;
+};
+
+#ifdef VIRTUAL_OUTPUT_SOCKET_SUPPORTED
+// Host-only utility: mirrors shown frames to a UNIX datagram socket for
+// external viewers. The firmware never compiles it (Arduino builds have no
+// UNIX sockets); host harnesses that drive VirtualOutput call send() after
+// each show().
+// Datagram layout (little endian):
+//   "MLVF" u32 frame u32 wireMicros u8 stripCount
+//   stripCount x { u16 start u16 count u8 colorOrder u8 bytesPerPixel }
+//   frame bytes, strips back to back in wire order
+// Sends never block; frames the receiver is too slow for (or that exceed the
+// socket buffer) are counted in `dropped`.
+class VirtualOutputMirror {
+ public:
+  ~VirtualOutputMirror() { close(); }
+
+  bool open(const char* path) {
+    close();
+    if (path == nullptr || std::strlen(path) >= sizeof(address_.sun_path)) {
+      return false;
+    }
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd_ < 0) {
+      return false;
+    }
+    std::memset(&address_, 0, sizeof(address_));
+    address_.sun_family = AF_UNIX;
+    std::strncpy(address_.sun_path, path, sizeof(address_.sun_path) - 1);
+    return true;
+  }
+
+  void close() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  bool isOpen() const { return fd_ >= 0; }
+
+  void send(const VirtualOutput& output) {
+    if (fd_ < 0) {
+      return;
+    }
+    packet_.clear();
+    const uint8_t magic[4] = {'M', 'L', 'V', 'F'};
+    packet_.insert(packet_.end(), magic, magic + 4);
+    put32(output.frames);
+    put32(output.frameMicros());
+    packet_.push_back(output.stripCount());
+    for (uint8_t i = 0; i < output.stripCount(); i++) {
+      const VirtualStripFrame& strip = output.strip(i);
+      put16(strip.start);
+      put16(strip.count);
+      packet_.push_back(strip.colorOrder);
+      packet_.push_back(strip.bytesPerPixel);
+    }
+    packet_.insert(packet_.end(), output.frame(), output.frame() + output.frameBytes());
+
+    const ssize_t sent = ::sendto(fd_, packet_.data(), packet_.size(), MSG_DONTWAIT,
+                                  reinterpret_cast<const sockaddr*>(&address_), sizeof(address_));
+    if (sent != static_cast<ssize_t>(packet_.size())) {
+      dropped++;
+    }
+  }
+
+  uint32_t dropped = 0;
+
+ private:
+  void put16(uint16_t value) {
+    packet_.push_back(static_cast<uint8_t>(value));
+    packet_.push_back(static_cast<uint8_t>(value >> 8));
+  }
+
+  void put32(uint32_t value) {
+    put16(static_cast<uint16_t>(value));
+    put16(static_cast<uint16_t>(value >> 16));
+  }
+
+  int fd_ = -1;
+  sockaddr_un address_{};
+  std::vector<uint8_t> packet_;
+};
+#endif
@@ -220,8 +220,8 @@ void getWLEDState(JsonObject& jsonState) {
   JsonObject mainseg = segments.createNestedObject();
   mainseg["id"] = 0;  // Main segment
   mainseg["start"] = 0;
-  mainseg["stop"] = pixelCount1 + pixelCount2;
-  mainseg["len"] = pixelCount1 + pixelCount2;
+  mainseg["stop"] = outputMap.totalPixels;
+  mainseg["len"] = outputMap.totalPixels;
   mainseg["grp"] = 1;  // Grouping (1 = individual control)
   mainseg["spc"] = 0;
   mainseg["of"] = 0;
@@ -294,7 +294,7 @@ void getWLEDInfo(JsonObject& info) {
   info["meshledReleaseSha"] = getResolvedMeshledReleaseSha();
 
   // LED information
-  info["leds"]["count"] = pixelCount1 + pixelCount2;
+  info["leds"]["count"] = outputMap.totalPixels;
   info["leds"]["rgbw"] = HAS_WHITE(colorOrder);
   // Keep numeric types aligned with WLED clients that decode this as an integer.
   info["leds"]["pwr"] = static_cast<uint32_t>(totalWattage + 0.5f);
@@ -426,6 +426,7 @@ void handleWLEDPost() {
   }
 
   bool shouldReturnState = doc.containsKey("v") && (bool) doc["v"];
+  markOutputDirty();
 
   // Process the state update
   bool shouldSaveSettings = false;
@@ -697,6 +698,7 @@ void applyWLEDWinArgs(bool& shouldSaveSettings) {
 void handleWLEDWin() {
   bool shouldSaveSettings = false;
   applyWLEDWinArgs(shouldSaveSettings);
+  markOutputDirty();
 
   if (shouldSaveSettings) {
     #ifdef SPIFFS_ENABLED
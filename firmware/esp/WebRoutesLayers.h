@@ -39,7 +39,7 @@ inline void registerPaletteRoutes(WebServer& web, FirmwareContext& context) {
   (void)context;
   web.on("/delete_palette", HTTP_POST, guardMutatingRoute(handleDeletePalette));
   web.on("/delete_palette", HTTP_OPTIONS, allowCORS("POST"));
-  web.on("/sync_palettes", HTTP_POST, guardMutatingRoute(handleSyncPalettes));
+  web.on("/sync_palettes", HTTP_POST, guardMutatingRoute(handleSyncPalettes), handleSyncPalettesUpload);
   web.on("/get_palettes", HTTP_GET, handleGetPalettes);
   web.on("/get_palettes", HTTP_OPTIONS, allowCORS("GET"));
 }
@@ -24,6 +24,17 @@ inline void registerSettingsRoutes(WebServer& web, FirmwareContext& context) {
   web.on("/trigger_crash", HTTP_POST, guardMutatingRoute(handleTriggerCrash));
 #endif
 
+#if defined(TRACE_ENABLED) && defined(SPIFFS_ENABLED)
+  web.on("/trace/start", HTTP_POST, guardProtectedRoute(handleTraceStart));
+  web.on("/trace/start", HTTP_OPTIONS, allowCORS("POST"));
+  web.on("/trace/stop", HTTP_POST, guardProtectedRoute(handleTraceStop));
+  web.on("/trace/stop", HTTP_OPTIONS, allowCORS("POST"));
+  web.on("/trace/status", HTTP_GET, guardProtectedRoute(handleTraceStatus));
+  web.on("/trace/status", HTTP_OPTIONS, allowCORS("GET"));
+  web.on("/trace/download", HTTP_GET, guardProtectedRoute(handleTraceDownload));
+  web.on("/trace/download", HTTP_OPTIONS, allowCORS("GET"));
+#endif
+
 #ifdef DEBUGGER_ENABLED
   web.on("/state_debug", HTTP_GET, handleStateDebug);
   web.on("/dump_connections", HTTP_GET, handleDumpConnections);
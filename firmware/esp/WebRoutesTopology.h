@@ -10,8 +10,11 @@ inline void registerTopologyRoutes(WebServer& web, FirmwareContext& context) {
   web.on("/get_model", HTTP_OPTIONS, allowCORS("GET"));
   web.on("/export_topology", HTTP_GET, handleExportTopology);
   web.on("/export_topology", HTTP_OPTIONS, allowCORS("GET"));
-  web.on("/import_topology", HTTP_POST, guardMutatingRoute(handleImportTopology));
+  web.on("/import_topology", HTTP_POST, guardMutatingRoute(handleImportTopology), handleImportTopologyUpload);
   web.on("/import_topology", HTTP_OPTIONS, allowCORS("POST"));
+  web.on("/topology_transaction", HTTP_POST, guardMutatingRoute(handleTopologyTransaction),
+         handleTopologyTransactionUpload);
+  web.on("/topology_transaction", HTTP_OPTIONS, allowCORS("POST"));
   web.on("/add_intersection", HTTP_POST, guardMutatingRoute(handleAddIntersection));
   web.on("/add_intersection", HTTP_OPTIONS, allowCORS("POST"));
   web.on("/remove_intersection", HTTP_POST, guardMutatingRoute(handleRemoveIntersection));
@@ -86,7 +86,20 @@ void handleGetSettings() {
   doc["pixelCount2"] = pixelCount2;
   doc["pixelPin1"] = pixelPin1;
   doc["pixelPin2"] = pixelPin2;
+  JsonArray outputsJson = doc.createNestedArray("outputs");
+  for (uint8_t i = 0; i < outputMap.stripCount; i++) {
+    const OutputStrip& output = outputMap.strips[i];
+    JsonObject entry = outputsJson.createNestedObject();
+    entry["strip"] = output.configIndex + 1;
+    entry["pin"] = output.pin;
+    entry["start"] = output.start;
+    entry["count"] = output.count;
+    entry["ledType"] = output.ledType;
+    entry["colorOrder"] = output.colorOrder;
+  }
   doc["pixelDensity"] = pixelDensity;
+  doc["outputRefreshMs"] = outputRefreshMs;
+  doc["simTickHz"] = simTickHz;
   doc["ledType"] = ledType;
   doc["colorOrder"] = colorOrder;
   doc["ledLibrary"] = ledLibrary;
@@ -101,21 +114,15 @@ void handleGetSettings() {
   doc["hasApiAuthToken"] = hasApiAuthTokenConfigured();
 
   JsonArray availableLedLibraries = doc.createNestedArray("availableLedLibraries");
-  if (isLedLibraryAvailable(LIB_NEOPIXELBUS)) {
-    availableLedLibraries.add(LIB_NEOPIXELBUS);
-  }
-  if (isLedLibraryAvailable(LIB_FASTLED)) {
-    availableLedLibraries.add(LIB_FASTLED);
-  }
-
   JsonObject unavailableLedLibraryReasons = doc.createNestedObject("unavailableLedLibraryReasons");
-  if (!isLedLibraryAvailable(LIB_NEOPIXELBUS)) {
-    const char* reason = ledLibraryUnavailableReason(LIB_NEOPIXELBUS);
-    unavailableLedLibraryReasons[String(LIB_NEOPIXELBUS)] = reason != NULL ? reason : "Unavailable";
-  }
-  if (!isLedLibraryAvailable(LIB_FASTLED)) {
-    const char* reason = ledLibraryUnavailableReason(LIB_FASTLED);
-    unavailableLedLibraryReasons[String(LIB_FASTLED)] = reason != NULL ? reason : "Unavailable";
+  for (size_t libraryIndex = 0; libraryIndex < knownLedLibraryCount(); libraryIndex++) {
+    uint8_t libraryId = knownLedLibraryAt(libraryIndex);
+    if (isLedLibraryAvailable(libraryId)) {
+      availableLedLibraries.add(libraryId);
+    } else {
+      const char* reason = ledLibraryUnavailableReason(libraryId);
+      unavailableLedLibraryReasons[String(libraryId)] = reason != NULL ? reason : "Unavailable";
+    }
   }
 
   JsonArray availableLedTypes = doc.createNestedArray("availableLedTypes");
@@ -49,7 +49,8 @@ void streamEmitter(WiFiClient &client) {
   client.printf("<label for='emitter_max_next'>Max Time Between Emits (ms): <span id='max-next-value'>%d</span></label>", emitterMaxNext);
   client.printf("<input type='range' id='emitter_max_next' name='emitter_max_next' min='1000' max='30000' step='1000' value='%d'>", emitterMaxNext);
   client.printf("<label for='emitter_from'>Emitter From Index: <span id='emitter-from-value'>%d</span></label>", emitterFrom);
-  client.printf("<input type='number' id='emitter_from' name='emitter_from' min='-1' max='255' value='%d'>", emitterFrom);
+  client.printf("<input type='number' id='emitter_from' name='emitter_from' min='-1' max='%ld' value='%d'>",
+                TOPOLOGY_MAX_INTERSECTION_ID, emitterFrom);
   client.println("</div>");
 
   // JavaScript is now loaded in the header from scripts.js
@@ -318,10 +319,10 @@ void handleUpdateEmitterMaxNext() {
 // Handle AJAX emitter from update
 void handleUpdateEmitterFrom() {
   if (server.hasArg("value")) {
-    int16_t newFrom = server.arg("value").toInt();
+    const long newFrom = server.arg("value").toInt();
 
-    // -1 means random start position, or any non-negative index
-    if (newFrom >= -1) {
+    // -1 means random start position, otherwise an intersection id the core can hold
+    if (newFrom >= -1 && newFrom <= TOPOLOGY_MAX_INTERSECTION_ID) {
       emitterFrom = newFrom;
 
       // Update the State's autoParams
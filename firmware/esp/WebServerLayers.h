@@ -143,15 +143,15 @@ void handleGetPaletteColors() {
         const UserPalette& userPalette = userPalettes[userIndex];
 
         // Convert the palette to hex colors
-        const std::vector<int64_t>& colors = userPalette.colors;
-        const std::vector<float>& positions = userPalette.positions;
+        const std::vector<uint32_t>& colors = userPalette.colors;
+        const std::vector<uint16_t>& positions = userPalette.positions;
 
         String jsonResponse = "{\"colors\":[";
 
         // Add color values as hex
         for (size_t i = 0; i < colors.size(); i++) {
           char hexBuffer[10];
-          sprintf(hexBuffer, "\"#%06X\"", (uint32_t)colors[i]);
+          sprintf(hexBuffer, "\"#%06X\"", colors[i]);
           jsonResponse += hexBuffer;
           if (i < colors.size() - 1) {
             jsonResponse += ",";
@@ -162,7 +162,7 @@ void handleGetPaletteColors() {
 
         // Add position values
         for (size_t i = 0; i < positions.size(); i++) {
-          jsonResponse += String(positions[i], 2);
+          jsonResponse += String(decodePalettePosition(positions[i]), 2);
           if (i < positions.size() - 1) {
             jsonResponse += ",";
           }
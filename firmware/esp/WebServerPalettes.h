@@ -35,62 +35,6 @@ void handleDeletePalette() {
   }
 }
 
-UserPalette paletteFromJson(const JsonObject& paletteObj, const String& paletteName) {
-  UserPalette newPalette;
-
-  // Extract basic properties
-  if (paletteObj.containsKey("name")) {
-    newPalette.name = paletteObj["name"].as<String>();
-  } else {
-    newPalette.name = paletteName;
-  }
-
-  newPalette.colorRule = paletteObj.containsKey("colorRule") ? paletteObj["colorRule"].as<int8_t>() : -1;
-  newPalette.interMode = paletteObj.containsKey("interMode") ? paletteObj["interMode"].as<int8_t>() : 1;
-  newPalette.wrapMode = paletteObj.containsKey("wrapMode") ? paletteObj["wrapMode"].as<int8_t>() : 0;
-  newPalette.segmentation = paletteObj.containsKey("segmentation") ? paletteObj["segmentation"].as<float>() : 0.0f;
-
-  // Extract colors
-  if (paletteObj.containsKey("colors") && paletteObj["colors"].is<JsonArray>()) {
-    JsonArray colorsArray = paletteObj["colors"];
-
-    for (JsonVariant colorVar : colorsArray) {
-      String colorStr = colorVar.as<String>();
-
-      // Remove # prefix if present
-      if (colorStr.startsWith("#")) {
-        colorStr = colorStr.substring(1);
-      }
-
-      // Convert hex string to integer
-      int64_t colorValue = strtoll(colorStr.c_str(), NULL, 16);
-      newPalette.colors.push_back(colorValue);
-    }
-  }
-
-  // Extract positions
-  if (paletteObj.containsKey("positions") && paletteObj["positions"].is<JsonArray>()) {
-    JsonArray positionsArray = paletteObj["positions"];
-
-    for (JsonVariant posVar : positionsArray) {
-      float position = posVar.as<float>();
-      newPalette.positions.push_back(position);
-    }
-  }
-
-  // If positions array is missing or has wrong size, generate default positions
-  if (newPalette.positions.size() != newPalette.colors.size()) {
-    newPalette.positions.clear();
-    for (size_t i = 0; i < newPalette.colors.size(); i++) {
-      float pos = (newPalette.colors.size() == 1) ? 0.0f :
-                  float(i) / float(newPalette.colors.size() - 1);
-      newPalette.positions.push_back(pos);
-    }
-  }
-
-  return newPalette;
-}
-
 void paletteToJson(JsonObject& paletteObj, const UserPalette& palette, bool fullDetails) {
   if (fullDetails) {
     paletteObj["name"] = palette.name;
@@ -101,16 +45,16 @@ void paletteToJson(JsonObject& paletteObj, const UserPalette& palette, bool full
 
     // Add colors array with hex values
     JsonArray colorsArray = paletteObj.createNestedArray("colors");
-    for (const int64_t& color : palette.colors) {
+    for (const uint32_t color : palette.colors) {
       char hexBuffer[10];
-      sprintf(hexBuffer, "#%06X", (uint32_t)color);
+      sprintf(hexBuffer, "#%06X", color);
       colorsArray.add(hexBuffer);
     }
 
     // Add positions array
     JsonArray positionsArray = paletteObj.createNestedArray("positions");
-    for (const float& position : palette.positions) {
-      positionsArray.add(position);
+    for (const uint16_t position : palette.positions) {
+      positionsArray.add(decodePalettePosition(position));
     }
   } else {
     // Names-only response
@@ -118,87 +62,165 @@ void paletteToJson(JsonObject& paletteObj, const UserPalette& palette, bool full
   }
 }
 
-void handleSyncPalettes() {
-  if (server.hasArg("plain")) {
-    server.sendHeader("Access-Control-Allow-Origin", "*");
-    server.sendHeader("Access-Control-Allow-Methods", "POST, OPTIONS");
-    server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-
-    bool push = false;
-    bool pull = false;
-    if (server.hasArg("push")) {
-      String pushArg = server.arg("push");
-      push = (pushArg == "1" || pushArg == "true");
-    }
-    if (server.hasArg("pull")) {
-      String pullArg = server.arg("pull");
-      pull = (pullArg == "1" || pullArg == "true");
+#ifndef PALETTE_SYNC_MAX_BYTES
+#define PALETTE_SYNC_MAX_BYTES 32768
+#endif
+
+// Collects the palettes of a /sync_palettes body as JsonStreamReader walks it.
+// Entries without a name are skipped.
+class PaletteListJsonSink : public JsonStreamSink {
+ public:
+  std::vector<UserPalette> palettes;
+  String error;
+
+  void reset() override {
+    palettes.clear();
+    palettes.shrink_to_fit();
+    pending_ = UserPalette();
+    error = "";
+    rootIsArray_ = false;
+  }
+
+  bool onContainerStart(const JsonStreamPath& path, bool isArray) override {
+    if (path.depth() == 0) {
+      rootIsArray_ = isArray;
+    } else if (path.is("[]") && !isArray) {
+      pending_ = UserPalette();
+      hasName_ = false;
     }
+    return true;
+  }
 
-    if (!push && !pull) {
-      server.send(400, "application/json", "{\"error\":\"push or pull not set\"}");
-      return;
+  bool onValue(const JsonStreamPath& path, const JsonStreamValue& value) override {
+    if (path.depth() == 0) {
+      rootIsArray_ = false;
+      return true;
+    }
+    if (path.parentIs("[]")) {
+      const char* key = path.key();
+      if (strcmp(key, "name") == 0) {
+        if (value.truncated) {
+          error = "Palette name too long";
+          return false;
+        }
+        pending_.name = value.isNull() ? "" : value.text;
+        hasName_ = true;
+      } else if (strcmp(key, "colorRule") == 0) {
+        pending_.colorRule = static_cast<int8_t>(value.toFloat());
+      } else if (strcmp(key, "interMode") == 0) {
+        pending_.interMode = static_cast<int8_t>(value.toFloat());
+      } else if (strcmp(key, "wrapMode") == 0) {
+        pending_.wrapMode = static_cast<int8_t>(value.toFloat());
+      } else if (strcmp(key, "segmentation") == 0) {
+        pending_.segmentation = value.toFloat();
+      }
+    } else if (path.is("[].colors[]")) {
+      // Colors are hex strings, optionally prefixed with '#'
+      const char* color = value.isNull() ? "" : value.text;
+      if (color[0] == '#') {
+        color++;
+      }
+      pending_.colors.push_back(static_cast<uint32_t>(strtoul(color, NULL, 16)));
+    } else if (path.is("[].positions[]")) {
+      pending_.positions.push_back(encodePalettePosition(value.toFloat()));
     }
+    return true;
+  }
 
-    String payload = server.arg("plain");
-    const size_t requestCapacity = std::max<size_t>(2048, payload.length() * 2);
-    DynamicJsonDocument doc(requestCapacity);
-    DeserializationError error = deserializeJson(doc, payload);
+  bool onContainerEnd(const JsonStreamPath& path, bool isArray) override {
+    if (path.is("[]") && !isArray && hasName_) {
+      if (pending_.positions.size() != pending_.colors.size()) {
+        pending_.fillDefaultPositions();
+      }
+      palettes.push_back(std::move(pending_));
+    }
+    return true;
+  }
 
-    if (error) {
-      LP_LOGF("Failed to parse JSON: %s\n", error.c_str());
-      server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-      return;
+  bool onDocumentEnd() override {
+    if (!rootIsArray_) {
+      error = "Expected JSON array";
+      return false;
     }
+    return true;
+  }
 
-    if (doc.is<JsonArray>()) {
-      JsonArray palettesArray = doc.as<JsonArray>();
-      std::vector<UserPalette> palettesToReturn = userPalettes;
-
-      // Response for the client
-      const size_t responseCapacity =
-          JSON_ARRAY_SIZE(palettesToReturn.size()) +
-          (palettesToReturn.size() * (JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(32) + JSON_ARRAY_SIZE(32) + 192));
-      DynamicJsonDocument responseDoc(responseCapacity > 1024 ? responseCapacity : 1024);
-
-      for (JsonObject paletteObj : palettesArray) {
-        if (paletteObj.containsKey("name")) {
-          String paletteName = paletteObj["name"].as<String>();
-
-          bool savePalette = true;
-          for (uint8_t i=0; i<palettesToReturn.size(); i++) {
-            const UserPalette& existing = palettesToReturn[i];
-            if (existing.name == paletteName) {
-              savePalette = false;
-              palettesToReturn.erase(palettesToReturn.begin() + i);
-              break;
-            }
-          }
-
-          if (savePalette && push) {
-            updateUserPalette(paletteFromJson(paletteObj, paletteName));
-          }
-        }
-      }
+ private:
+  UserPalette pending_;
+  bool hasName_ = false;
+  bool rootIsArray_ = false;
+};
 
-      JsonArray responseArray = responseDoc.to<JsonArray>();
-      if (pull) {
-        for (const UserPalette& toReturn : palettesToReturn) {
-          JsonObject paletteObj = responseArray.createNestedObject();
-          paletteToJson(paletteObj, toReturn, true);
-        }
+PaletteListJsonSink gPaletteSyncSink;
+
+void handleSyncPalettesUpload() {
+  streamRawJsonBody(gPaletteSyncSink, PALETTE_SYNC_MAX_BYTES);
+}
+
+void handleSyncPalettes() {
+  server.sendHeader("Access-Control-Allow-Origin", "*");
+  server.sendHeader("Access-Control-Allow-Methods", "POST, OPTIONS");
+  server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
+
+  bool push = false;
+  bool pull = false;
+  if (server.hasArg("push")) {
+    String pushArg = server.arg("push");
+    push = (pushArg == "1" || pushArg == "true");
+  }
+  if (server.hasArg("pull")) {
+    String pullArg = server.arg("pull");
+    pull = (pullArg == "1" || pullArg == "true");
+  }
+
+  if (!push && !pull) {
+    discardRequestBody();
+    server.send(400, "application/json", "{\"error\":\"push or pull not set\"}");
+    return;
+  }
+
+  if (!finishJsonRequestBody(gPaletteSyncSink, gPaletteSyncSink.error, PALETTE_SYNC_MAX_BYTES)) {
+    gPaletteSyncSink.reset();
+    return;
+  }
+
+  std::vector<UserPalette> palettesToReturn = userPalettes;
+
+  // Response for the client
+  const size_t responseCapacity =
+      JSON_ARRAY_SIZE(palettesToReturn.size()) +
+      (palettesToReturn.size() * (JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(32) + JSON_ARRAY_SIZE(32) + 192));
+  DynamicJsonDocument responseDoc(responseCapacity > 1024 ? responseCapacity : 1024);
+
+  for (const UserPalette& palette : gPaletteSyncSink.palettes) {
+    bool savePalette = true;
+    for (uint8_t i=0; i<palettesToReturn.size(); i++) {
+      const UserPalette& existing = palettesToReturn[i];
+      if (existing.name == palette.name) {
+        savePalette = false;
+        palettesToReturn.erase(palettesToReturn.begin() + i);
+        break;
       }
+    }
 
-      // Send response
-      String jsonResponse;
-      serializeJson(responseDoc, jsonResponse);
-      server.send(200, "application/json", jsonResponse);
-    } else {
-      server.send(400, "application/json", "{\"error\":\"Expected JSON array\"}");
+    if (savePalette && push) {
+      updateUserPalette(palette);
+    }
+  }
+  gPaletteSyncSink.reset();
+
+  JsonArray responseArray = responseDoc.to<JsonArray>();
+  if (pull) {
+    for (const UserPalette& toReturn : palettesToReturn) {
+      JsonObject paletteObj = responseArray.createNestedObject();
+      paletteToJson(paletteObj, toReturn, true);
     }
-  } else {
-    server.send(400, "application/json", "{\"error\":\"Expected JSON payload\"}");
   }
+
+  // Send response
+  String jsonResponse;
+  serializeJson(responseDoc, jsonResponse);
+  server.send(200, "application/json", jsonResponse);
 }
 
 // Handler for fetching user palettes as JSON
@@ -341,8 +363,7 @@ void handleSavePalette() {
           colorStr = colorStr.substring(1);
         }
         // Convert hex string to integer
-        int64_t color = strtol(colorStr.c_str(), NULL, 16);
-        palette.colors.push_back(color);
+        palette.colors.push_back(static_cast<uint32_t>(strtoul(colorStr.c_str(), NULL, 16)));
       }
     }
   }
@@ -358,20 +379,14 @@ void handleSavePalette() {
     JsonArray posArray = doc["positions"].as<JsonArray>();
     for (JsonVariant posVar : posArray) {
       if (posVar.is<float>()) {
-        palette.positions.push_back(posVar.as<float>());
+        palette.positions.push_back(encodePalettePosition(posVar.as<float>()));
       }
     }
   }
 
   // Ensure positions match colors
   if (palette.positions.size() != palette.colors.size()) {
-    // Generate default positions
-    palette.positions.clear();
-    for (size_t i = 0; i < palette.colors.size(); i++) {
-      float pos = (palette.colors.size() == 1) ? 0.0f :
-                  static_cast<float>(i) / static_cast<float>(palette.colors.size() - 1);
-      palette.positions.push_back(pos);
-    }
+    palette.fillDefaultPositions();
   }
 
   // Extract other properties
@@ -3,8 +3,14 @@
 #include <algorithm>
 #include <ArduinoJson.h>
 #include <functional>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include "ConnectionPlanner.h"
 #include "ExternalTransport.h"
+#include "JsonStreamReader.h"
 #include "SecurityLib.h"
+#include "TopologyBinary.h"
 #include "WebServerValidation.h"
 
 #ifdef OTA_ENABLED
@@ -33,6 +39,7 @@
 #endif
 
 void sendCORSHeaders(String methods);
+void discardRequestBody();
 
 bool isApiRequestAuthorized() {
   if (!apiAuthEnabled) {
@@ -67,9 +74,22 @@ bool requireApiAuth() {
 std::function<void(void)> guardMutatingRoute(void (*handler)()) {
   return [handler]() {
     if (!requireApiAuth()) {
+      // Raw upload callbacks run before this check; drop what they parsed.
+      discardRequestBody();
       return;
     }
-    handler();
+    if (isTraceActive()) {
+      traceBeginHttpRequest(server.uri().c_str());
+      for (int i = 0; i < server.args(); i++) {
+        traceAppendHttpArg(server.argName(i).c_str(), server.arg(i).c_str());
+      }
+      traceCommitHttpRequest();
+    }
+    {
+      AllocScope allocScope(ALLOC_PHASE_HTTP);
+      handler();
+    }
+    markOutputDirty();
   };
 }
 
@@ -88,6 +108,71 @@ void sendCORSHeaders(String methods = "GET, POST, PUT, DELETE") {
   server.sendHeader("Access-Control-Allow-Headers", "Content-Type, Authorization, X-Requested-With");
 }
 
+JsonStreamReader gJsonRequestReader;
+
+// Upload callback for routes registered with a raw handler: binds `sink` when the
+// body starts and feeds each chunk to gJsonRequestReader as it arrives. Nothing
+// may be applied from here, the route guard only runs before the final handler.
+void streamRawJsonBody(JsonStreamSink& sink, size_t maxBytes) {
+  HTTPRaw& raw = server.raw();
+  if (raw.status == RAW_START) {
+    sink.reset();
+    gJsonRequestReader.begin(&sink, maxBytes);
+  } else if (raw.status == RAW_WRITE) {
+    gJsonRequestReader.feed(raw.buf, raw.currentSize);
+  } else if (raw.status == RAW_END) {
+    gJsonRequestReader.finish();
+  } else if (raw.status == RAW_ABORTED) {
+    gJsonRequestReader.begin(nullptr, 0);
+  }
+}
+
+// Final-handler side of streamRawJsonBody. Bodies that did not come through the
+// raw callback (form posts) are read from the "plain" arg instead. Sends the
+// error response and returns false unless `sink` holds a complete document.
+bool finishJsonRequestBody(JsonStreamSink& sink, const String& sinkError, size_t maxBytes) {
+  if (gJsonRequestReader.sink() != &sink) {
+    sink.reset();
+    gJsonRequestReader.begin(&sink, maxBytes);
+    const String body = server.arg("plain");
+    gJsonRequestReader.feed(body.c_str(), body.length());
+  }
+  if (gJsonRequestReader.received() == 0) {
+    gJsonRequestReader.begin(nullptr, 0);
+    server.send(400, "application/json", "{\"error\":\"Missing JSON payload\"}");
+    return false;
+  }
+
+  gJsonRequestReader.finish();
+  const bool tooLarge = gJsonRequestReader.tooLarge();
+  const bool ok = gJsonRequestReader.finished();
+  const String error = gJsonRequestReader.sinkRejected() ? sinkError : String(gJsonRequestReader.error());
+  gJsonRequestReader.begin(nullptr, 0);
+
+  if (tooLarge) {
+    server.send(413, "application/json", "{\"error\":\"Request body too large\"}");
+    return false;
+  }
+  if (!ok) {
+    server.send(400, "application/json", "{\"error\":\"" + error + "\"}");
+    return false;
+  }
+  return true;
+}
+
+void resetTopologyImportUpload();
+
+// Drops whatever the raw upload callbacks collected for a request whose handler
+// will not consume it (rejected by the route guard, or failed before reading
+// the body), so the parsed data is not held until the next request.
+void discardRequestBody() {
+  if (JsonStreamSink* sink = gJsonRequestReader.sink()) {
+    sink->reset();
+  }
+  gJsonRequestReader.begin(nullptr, 0);
+  resetTopologyImportUpload();
+}
+
 #include "WebServerLayers.h"
 #include "WebServerPalettes.h"
 
@@ -203,74 +288,96 @@ void handleWifiPage() {
   sendRecoverySetupPage();
 }
 
-// Helper function to check if intersections are already connected
-bool areIntersectionsConnected(Intersection* inter1, Intersection* inter2) {
-  for (uint8_t g = 0; g < MAX_GROUPS; g++) {
-    for (Connection* conn : object->conn[g]) {
-      if (conn && ((conn->from == inter1 && conn->to == inter2) || 
-                   (conn->from == inter2 && conn->to == inter1))) {
-        return true;
-      }
+// Helper function to check if testInter sits on the strip between inter1 and
+// inter2; callers have already checked that its topPixel lies strictly between.
+bool isIntersectionBlockingPath(Intersection* inter1, Intersection* inter2, Intersection* testInter) {
+  // If all three intersections have bottomPixels, check if the path is clear
+  if (inter1->bottomPixel != -1 && inter2->bottomPixel != -1 && testInter->bottomPixel != -1) {
+    uint16_t startBottom = inter1->bottomPixel;
+    uint16_t endBottom = inter2->bottomPixel;
+    if (startBottom > endBottom) {
+      std::swap(startBottom, endBottom);
+    }
+
+    // If the blocking intersection's bottomPixel is not in the path, it's not blocking
+    if (testInter->bottomPixel <= startBottom || testInter->bottomPixel >= endBottom) {
+      return false;
     }
   }
-  return false;
+  return true;
 }
 
-// Helper function to check if there are intersections between two intersections
-bool hasIntersectionBetween(Intersection* inter1, Intersection* inter2) {
-  if (!inter1 || !inter2) return false;
-  
-  uint16_t startPixel = inter1->topPixel;
-  uint16_t endPixel = inter2->topPixel;
-  
-  // Ensure startPixel < endPixel
-  if (startPixel > endPixel) {
-    uint16_t temp = startPixel;
-    startPixel = endPixel;
-    endPixel = temp;
+// Intersections indexed for recalculateConnections(): every intersection once, in
+// first-seen order across object->inter[], and per group mask the intersections
+// that can block a path sorted by topPixel, so "is anything between A and B"
+// only visits the intersections whose topPixel lies between them.
+struct IntersectionIndex {
+  std::vector<Intersection*> ordered;
+  std::unordered_map<Intersection*, size_t> ordinals;
+  std::map<uint8_t, std::vector<Intersection*>> blockersByMask;
+
+  void build() {
+    ordered.clear();
+    ordinals.clear();
+    blockersByMask.clear();
+    for (uint8_t g = 0; g < MAX_GROUPS; g++) {
+      for (Intersection* intersection : object->inter[g]) {
+        if (intersection && ordinals.emplace(intersection, ordered.size()).second) {
+          ordered.push_back(intersection);
+        }
+      }
+    }
   }
-  
-  // Check if any other intersection exists between these two
-  for (uint8_t g = 0; g < MAX_GROUPS; g++) {
-    // Only check intersections in the same or compatible groups
-    if (!(inter1->group & TopologyObject::groupMaskForIndex(g)) &&
-        !(inter2->group & TopologyObject::groupMaskForIndex(g))) {
-      continue;
+
+  // Intersections from every group list selected by `mask`, sorted by topPixel.
+  const std::vector<Intersection*>& blockersFor(uint8_t mask) {
+    auto found = blockersByMask.find(mask);
+    if (found != blockersByMask.end()) {
+      return found->second;
     }
-    
-    for (Intersection* testInter : object->inter[g]) {
-      if (!testInter || testInter == inter1 || testInter == inter2) continue;
-      
-      // Check if this intersection is between the two
-      if (testInter->topPixel > startPixel && testInter->topPixel < endPixel) {
-        // Also check bottomPixel if it exists
-        bool isBlocking = true;
-        
-        // If both intersections have bottomPixels, check if the path is clear
-        if (inter1->bottomPixel != -1 && inter2->bottomPixel != -1 && testInter->bottomPixel != -1) {
-          uint16_t startBottom = inter1->bottomPixel;
-          uint16_t endBottom = inter2->bottomPixel;
-          if (startBottom > endBottom) {
-            uint16_t temp = startBottom;
-            startBottom = endBottom;
-            endBottom = temp;
-          }
-          
-          // If the blocking intersection's bottomPixel is not in the path, it's not blocking
-          if (testInter->bottomPixel <= startBottom || testInter->bottomPixel >= endBottom) {
-            isBlocking = false;
-          }
-        }
-        
-        if (isBlocking) {
-          return true; // There is an intersection between them
+    std::vector<Intersection*>& blockers = blockersByMask[mask];
+    for (uint8_t g = 0; g < MAX_GROUPS; g++) {
+      if (!(mask & TopologyObject::groupMaskForIndex(g))) {
+        continue;
+      }
+      for (Intersection* intersection : object->inter[g]) {
+        if (intersection) {
+          blockers.push_back(intersection);
         }
       }
     }
+    std::sort(blockers.begin(), blockers.end(), [](Intersection* a, Intersection* b) {
+      return a->topPixel != b->topPixel ? a->topPixel < b->topPixel : a < b;
+    });
+    blockers.erase(std::unique(blockers.begin(), blockers.end()), blockers.end());
+    return blockers;
   }
-  
-  return false; // No intersections between them
-}
+
+  // First blocker after `from` (topPixel strictly greater) in a topPixel-sorted list.
+  static std::vector<Intersection*>::const_iterator firstAbove(const std::vector<Intersection*>& blockers,
+                                                              uint16_t topPixel) {
+    return std::upper_bound(blockers.begin(), blockers.end(), topPixel,
+                            [](uint16_t pixel, Intersection* intersection) {
+                              return pixel < intersection->topPixel;
+                            });
+  }
+
+  bool hasIntersectionBetween(Intersection* inter1, Intersection* inter2) {
+    if (!inter1 || !inter2) return false;
+
+    const uint16_t startPixel = std::min(inter1->topPixel, inter2->topPixel);
+    const uint16_t endPixel = std::max(inter1->topPixel, inter2->topPixel);
+    const std::vector<Intersection*>& blockers = blockersFor(inter1->group | inter2->group);
+    for (auto it = firstAbove(blockers, startPixel); it != blockers.end() && (*it)->topPixel < endPixel; ++it) {
+      Intersection* testInter = *it;
+      if (testInter == inter1 || testInter == inter2) continue;
+      if (isIntersectionBlockingPath(inter1, inter2, testInter)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
 
 // Helper function to check if intersection has available ports
 bool hasAvailablePort(Intersection* intersection) {
@@ -296,7 +403,7 @@ uint8_t getGroupIndex(uint8_t group) {
   return MAX_GROUPS; // Invalid
 }
 
-Intersection* findIntersectionById(uint8_t intersectionId) {
+Intersection* findIntersectionById(TopologyIntersectionId intersectionId) {
   if (!object) {
     return nullptr;
   }
@@ -348,7 +455,10 @@ bool hasSpaceForConnection(uint8_t groupIndex) {
 // Helper function to recalculate connections
 void recalculateConnections() {
   if (!object) return;
-  
+
+  IntersectionIndex intersectionIndex;
+  intersectionIndex.build();
+
   // First pass: Remove connections that now have intersections between their endpoints
   // BUT preserve virtual connections (bridges with numLeds = 0)
   std::vector<std::pair<uint8_t, size_t>> connectionsToRemove;
@@ -363,7 +473,7 @@ void recalculateConnections() {
       if (conn->numLeds == 0) continue;
       
       // Check if there are now intersections between the connection endpoints
-      if (hasIntersectionBetween(conn->from, conn->to)) {
+      if (intersectionIndex.hasIntersectionBetween(conn->from, conn->to)) {
         connectionsToRemove.push_back({g, i});
         LP_LOGF("Removing physical connection from %d to %d (intersection now exists between them)\n", 
                conn->from->topPixel, conn->to->topPixel);
@@ -377,50 +487,101 @@ void recalculateConnections() {
     size_t index = it->second;
     object->removeConnection(group, index);
   }
-  
-  // Second pass: Auto-connect intersections with no intersections in between
-  for (uint8_t g1 = 0; g1 < MAX_GROUPS; g1++) {
-    for (size_t i1 = 0; i1 < object->inter[g1].size(); i1++) {
-      Intersection* inter1 = object->inter[g1][i1];
-      if (!inter1) continue;
-      
-      for (uint8_t g2 = g1; g2 < MAX_GROUPS; g2++) {
-        size_t startI2 = (g2 == g1) ? i1 + 1 : 0;
-        for (size_t i2 = startI2; i2 < object->inter[g2].size(); i2++) {
-          Intersection* inter2 = object->inter[g2][i2];
-          if (!inter2) continue;
-          
-          // Only connect within same group or compatible groups
-          if (inter1->group != inter2->group) continue;
-          
-          // Check if already connected
-          if (areIntersectionsConnected(inter1, inter2)) continue;
-          
-          // Check if there are no intersections between them
-          if (hasIntersectionBetween(inter1, inter2)) continue;
-          
-          // Check if both intersections have available ports
-          if (hasAvailablePort(inter1) && hasAvailablePort(inter2)) {
-            
-            // Check if we have space for new connection
-            uint8_t groupIndex = getGroupIndex(inter1->group);
-            if (groupIndex < MAX_GROUPS && hasSpaceForConnection(groupIndex)) {
-              
-              // Calculate the number of LEDs between intersections
-              uint16_t numLeds = abs((int)inter2->topPixel - (int)inter1->topPixel) - 1;
-              
-              // Create new connection
-              Connection* newConn = new Connection(inter1, inter2, inter1->group, numLeds);
-              object->addConnection(newConn);
-              
-              LP_LOGF("Auto-connected intersections %d (%d) and %d (%d) with %d LEDs\n", 
-                     inter1->id, inter1->topPixel, inter2->id, inter2->topPixel, numLeds);
-            }
-          }
-        }
+
+  std::set<std::pair<Intersection*, Intersection*>> connected;
+  for (uint8_t g = 0; g < MAX_GROUPS; g++) {
+    for (Connection* conn : object->conn[g]) {
+      if (conn) {
+        connected.insert(std::minmax(conn->from, conn->to));
       }
     }
   }
+
+  // Second pass: connect pairs of same-group intersections with no intersection in
+  // between, nearest partner first (see ConnectionPlanner.h).
+  std::map<uint8_t, std::vector<Intersection*>> byGroup;
+  for (Intersection* intersection : intersectionIndex.ordered) {
+    byGroup[intersection->group].push_back(intersection);
+  }
+
+  ConnectionPlanner planner;
+  for (auto& entry : byGroup) {
+    planner.planGroup(entry.second, hasAvailablePort, [&](Intersection* inter1, Intersection* inter2) {
+      // Check if already connected
+      if (connected.count(std::minmax(inter1, inter2)) > 0) return;
+
+      // Check if we have space for new connection
+      uint8_t groupIndex = getGroupIndex(inter1->group);
+      if (groupIndex < MAX_GROUPS && hasSpaceForConnection(groupIndex)) {
+
+        // Calculate the number of LEDs between intersections
+        uint16_t numLeds = abs((int)inter2->topPixel - (int)inter1->topPixel) - 1;
+
+        // Create new connection
+        Connection* newConn = new Connection(inter1, inter2, inter1->group, numLeds);
+        object->addConnection(newConn);
+        connected.insert(std::minmax(inter1, inter2));
+
+        LP_LOGF("Auto-connected intersections %d (%d) and %d (%d) with %d LEDs\n", 
+               inter1->id, inter1->topPixel, inter2->id, inter2->topPixel, numLeds);
+      }
+    });
+  }
+}
+
+#ifndef TOPOLOGY_TRANSACTION_MAX_OPS
+#define TOPOLOGY_TRANSACTION_MAX_OPS 64
+#endif
+
+// Bounds the request body; 64 ops fit comfortably.
+#ifndef TOPOLOGY_TRANSACTION_MAX_BYTES
+#define TOPOLOGY_TRANSACTION_MAX_BYTES 16384
+#endif
+
+// Outcome of one topology edit, shared by the single-edit routes and
+// /topology_transaction.
+struct TopologyOpResult {
+  int status = 200;
+  String error;
+  long id = -1;
+
+  bool fail(int failStatus, const char* message) {
+    status = failStatus;
+    error = message;
+    return false;
+  }
+};
+
+void sendTopologyOpError(const TopologyOpResult& result) {
+  server.send(result.status, "application/json", "{\"error\":\"" + result.error + "\"}");
+}
+
+bool applyAddIntersection(JsonObjectConst args, TopologyOpResult& result) {
+  // Required parameters
+  if (!args.containsKey("numPorts") || !args.containsKey("topPixel") || !args.containsKey("group")) {
+    return result.fail(400, "Missing required parameters: numPorts, topPixel, group");
+  }
+  
+  uint8_t numPorts = args["numPorts"];
+  uint16_t topPixel = args["topPixel"];
+  uint8_t group = args["group"];
+  int16_t bottomPixel = args.containsKey("bottomPixel") ? (int16_t)args["bottomPixel"] : -1;
+  
+  // Validate parameters
+  if (numPorts != 2 && numPorts != 4) {
+    return result.fail(400, "numPorts must be 2 or 4");
+  }
+  
+  const uint8_t maxGroupMask = static_cast<uint8_t>((1u << MAX_GROUPS) - 1u);
+  if (group == 0 || group > maxGroupMask || (group & (group - 1)) != 0) {
+    return result.fail(400, "group must be a single valid group bit");
+  }
+  
+  // Create and add the intersection
+  Intersection* intersection = new Intersection(numPorts, topPixel, bottomPixel, group);
+  object->addIntersection(intersection);
+  result.id = intersection->id;
+  return true;
 }
 
 // Add intersection to the model
@@ -442,46 +603,16 @@ void handleAddIntersection() {
     return;
   }
   
-  // Required parameters
-  if (!doc.containsKey("numPorts") || !doc.containsKey("topPixel") || !doc.containsKey("group")) {
-    server.send(400, "application/json", "{\"error\":\"Missing required parameters: numPorts, topPixel, group\"}");
-    return;
-  }
-  
-  uint8_t numPorts = doc["numPorts"];
-  uint16_t topPixel = doc["topPixel"];
-  uint8_t group = doc["group"];
-  int16_t bottomPixel = doc.containsKey("bottomPixel") ? (int16_t)doc["bottomPixel"] : -1;
-  
-  // Validate parameters
-  if (numPorts != 2 && numPorts != 4) {
-    server.send(400, "application/json", "{\"error\":\"numPorts must be 2 or 4\"}");
-    return;
-  }
-  
-  const uint8_t maxGroupMask = static_cast<uint8_t>((1u << MAX_GROUPS) - 1u);
-  if (group == 0 || group > maxGroupMask || (group & (group - 1)) != 0) {
-    server.send(400, "application/json", "{\"error\":\"group must be a single valid group bit\"}");
+  TopologyOpResult result;
+  if (!applyAddIntersection(doc.as<JsonObjectConst>(), result)) {
+    sendTopologyOpError(result);
     return;
   }
   
-  // Get group index for validation
-  uint8_t groupIndex = 0;
-  for (uint8_t i = 0; i < MAX_GROUPS; i++) {
-    if (group & TopologyObject::groupMaskForIndex(i)) {
-      groupIndex = i;
-      break;
-    }
-  }
-  
-  // Create and add the intersection
-  Intersection* intersection = new Intersection(numPorts, topPixel, bottomPixel, group);
-  object->addIntersection(intersection);
-  
   // Recalculate connections for affected models
   recalculateConnections();
   
-  server.send(200, "application/json", "{\"success\":true,\"id\":" + String(intersection->id) + "}");
+  server.send(200, "application/json", "{\"success\":true,\"id\":" + String(result.id) + "}");
 }
 
 // Helper function to clean up model weights related to an intersection
@@ -500,33 +631,17 @@ void cleanupModelWeights(Intersection* intersection) {
   }
 }
 
-// Remove intersection from the model
-void handleRemoveIntersection() {
-  sendCORSHeaders("POST");
-  
-  if (!object) {
-    server.send(404, "application/json", "{\"error\":\"No model object available\"}");
-    return;
-  }
-  
-  // Parse JSON parameters
-  String body = server.arg("plain");
-  DynamicJsonDocument doc(512);
-  DeserializationError error = deserializeJson(doc, body);
-  
-  if (error) {
-    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-    return;
-  }
-  
+bool applyRemoveIntersection(JsonObjectConst args, TopologyOpResult& result) {
   // Required parameters
-  if (!doc.containsKey("id") || !doc.containsKey("group")) {
-    server.send(400, "application/json", "{\"error\":\"Missing required parameters: id, group\"}");
-    return;
+  if (!args.containsKey("id") || !args.containsKey("group")) {
+    return result.fail(400, "Missing required parameters: id, group");
   }
   
-  const uint8_t intersectionId = doc["id"];
-  const uint8_t requestedGroup = doc["group"];
+  const long intersectionId = args["id"];
+  if (intersectionId < 0 || intersectionId > TOPOLOGY_MAX_INTERSECTION_ID) {
+    return result.fail(400, "Invalid id");
+  }
+  const uint8_t requestedGroup = args["group"];
   const uint8_t maxGroupMask = static_cast<uint8_t>((1u << MAX_GROUPS) - 1u);
 
   // Prefer group-index lookup to preserve compatibility with current UI payloads.
@@ -571,96 +686,98 @@ void handleRemoveIntersection() {
   }
   
   if (!target) {
-    server.send(404, "application/json", "{\"error\":\"Intersection not found\"}");
-    return;
+    return result.fail(404, "Intersection not found");
   }
 
   // Remove related model weights first, then delegate ownership-safe removal.
   cleanupModelWeights(target);
   if (!object->removeIntersection(target)) {
-    server.send(500, "application/json", "{\"error\":\"Failed to remove intersection\"}");
-    return;
+    return result.fail(500, "Failed to remove intersection");
   }
-  
-  // Recalculate connections for affected models
-  recalculateConnections();
-  
-  server.send(200, "application/json", "{\"success\":true}");
+  return true;
 }
 
-void handleAddExternalPort() {
+// Remove intersection from the model
+void handleRemoveIntersection() {
   sendCORSHeaders("POST");
-
+  
   if (!object) {
     server.send(404, "application/json", "{\"error\":\"No model object available\"}");
     return;
   }
-
+  
+  // Parse JSON parameters
   String body = server.arg("plain");
-  DynamicJsonDocument doc(1024);
+  DynamicJsonDocument doc(512);
   DeserializationError error = deserializeJson(doc, body);
+  
   if (error) {
     server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
     return;
   }
-
-  if (!doc.containsKey("intersectionId") || !doc.containsKey("slotIndex") || !doc.containsKey("group") ||
-      !doc.containsKey("deviceMac") || !doc.containsKey("targetPortId")) {
-    server.send(400, "application/json",
-                "{\"error\":\"Missing required parameters: intersectionId, slotIndex, group, deviceMac, targetPortId\"}");
+  
+  TopologyOpResult result;
+  if (!applyRemoveIntersection(doc.as<JsonObjectConst>(), result)) {
+    sendTopologyOpError(result);
     return;
   }
+  
+  // Recalculate connections for affected models
+  recalculateConnections();
+  
+  server.send(200, "application/json", "{\"success\":true}");
+}
+
+bool applyAddExternalPort(JsonObjectConst args, TopologyOpResult& result) {
+  if (!args.containsKey("intersectionId") || !args.containsKey("slotIndex") || !args.containsKey("group") ||
+      !args.containsKey("deviceMac") || !args.containsKey("targetPortId")) {
+    return result.fail(400, "Missing required parameters: intersectionId, slotIndex, group, deviceMac, targetPortId");
+  }
 
-  long intersectionId = doc["intersectionId"];
-  long slotIndex = doc["slotIndex"];
-  long group = doc["group"];
-  long targetPortId = doc["targetPortId"];
-  const bool direction = doc.containsKey("direction") ? static_cast<bool>(doc["direction"]) : false;
+  long intersectionId = args["intersectionId"];
+  long slotIndex = args["slotIndex"];
+  long group = args["group"];
+  long targetPortId = args["targetPortId"];
+  const bool direction = args.containsKey("direction") ? static_cast<bool>(args["direction"]) : false;
 
-  if (intersectionId < 0 || intersectionId > 255 || slotIndex < 0 || slotIndex > 255 ||
-      group < 1 || group > 255 || targetPortId < 0 || targetPortId > 255) {
-    server.send(400, "application/json", "{\"error\":\"Invalid numeric parameter range\"}");
-    return;
+  if (intersectionId < 0 || intersectionId > TOPOLOGY_MAX_INTERSECTION_ID || slotIndex < 0 || slotIndex > 255 ||
+      group < 1 || group > 255 || targetPortId < 0 || targetPortId > TOPOLOGY_MAX_PORT_ID) {
+    return result.fail(400, "Invalid numeric parameter range");
   }
 
   const uint8_t maxGroupMask = static_cast<uint8_t>((1u << MAX_GROUPS) - 1u);
   if ((group & (group - 1)) != 0 || group > maxGroupMask) {
-    server.send(400, "application/json", "{\"error\":\"group must be a single valid group bit\"}");
-    return;
+    return result.fail(400, "group must be a single valid group bit");
   }
 
-  Intersection* intersection = findIntersectionById(static_cast<uint8_t>(intersectionId));
+  Intersection* intersection = findIntersectionById(static_cast<TopologyIntersectionId>(intersectionId));
   if (!intersection) {
-    server.send(404, "application/json", "{\"error\":\"Intersection not found\"}");
-    return;
+    return result.fail(404, "Intersection not found");
   }
   if (slotIndex >= static_cast<long>(intersection->numPorts)) {
-    server.send(400, "application/json", "{\"error\":\"slotIndex out of range for intersection\"}");
-    return;
+    return result.fail(400, "slotIndex out of range for intersection");
   }
   if (intersection->ports[slotIndex] != nullptr) {
-    server.send(400, "application/json", "{\"error\":\"Requested slot is already occupied\"}");
-    return;
+    return result.fail(400, "Requested slot is already occupied");
   }
 
   uint8_t deviceMac[6] = {0};
-  if (!parseMacAddress(String(doc["deviceMac"].as<const char*>()), deviceMac)) {
-    server.send(400, "application/json", "{\"error\":\"Invalid deviceMac format\"}");
-    return;
+  if (!parseMacAddress(String(args["deviceMac"].as<const char*>()), deviceMac)) {
+    return result.fail(400, "Invalid deviceMac format");
   }
 
   ExternalPort* created = object->addExternalPort(intersection, static_cast<uint8_t>(slotIndex), direction,
                                                   static_cast<uint8_t>(group), deviceMac,
-                                                  static_cast<uint8_t>(targetPortId));
+                                                  static_cast<TopologyPortId>(targetPortId));
   if (!created) {
-    server.send(500, "application/json", "{\"error\":\"Failed to create external port\"}");
-    return;
+    return result.fail(500, "Failed to create external port");
   }
 
-  server.send(200, "application/json", "{\"success\":true,\"id\":" + String(created->id) + "}");
+  result.id = created->id;
+  return true;
 }
 
-void handleUpdateExternalPort() {
+void handleAddExternalPort() {
   sendCORSHeaders("POST");
 
   if (!object) {
@@ -676,63 +793,70 @@ void handleUpdateExternalPort() {
     return;
   }
 
-  if (!doc.containsKey("portId")) {
-    server.send(400, "application/json", "{\"error\":\"Missing required parameter: portId\"}");
+  TopologyOpResult result;
+  if (!applyAddExternalPort(doc.as<JsonObjectConst>(), result)) {
+    sendTopologyOpError(result);
     return;
   }
 
-  long portId = doc["portId"];
-  if (portId < 0 || portId > 255) {
-    server.send(400, "application/json", "{\"error\":\"Invalid portId\"}");
-    return;
+  server.send(200, "application/json", "{\"success\":true,\"id\":" + String(result.id) + "}");
+}
+
+bool applyUpdateExternalPort(JsonObjectConst args, TopologyOpResult& result) {
+  if (!args.containsKey("portId")) {
+    return result.fail(400, "Missing required parameter: portId");
+  }
+
+  long portId = args["portId"];
+  if (portId < 0 || portId > TOPOLOGY_MAX_PORT_ID) {
+    return result.fail(400, "Invalid portId");
   }
 
-  Port* rawPort = Port::findById(static_cast<uint8_t>(portId));
+  Port* rawPort = Port::findById(static_cast<TopologyPortId>(portId));
   if (!rawPort || !rawPort->isExternal()) {
-    server.send(404, "application/json", "{\"error\":\"External port not found\"}");
-    return;
+    return result.fail(404, "External port not found");
   }
 
   auto* port = static_cast<ExternalPort*>(rawPort);
 
-  if (doc.containsKey("direction")) {
-    port->direction = static_cast<bool>(doc["direction"]);
-  }
-
-  if (doc.containsKey("group")) {
-    long group = doc["group"];
+  // Validate everything before touching the port so a rejected update leaves it unchanged.
+  long group = port->group;
+  if (args.containsKey("group")) {
+    group = args["group"];
     const uint8_t maxGroupMask = static_cast<uint8_t>((1u << MAX_GROUPS) - 1u);
     if (group < 1 || group > maxGroupMask || (group & (group - 1)) != 0) {
-      server.send(400, "application/json", "{\"error\":\"group must be a single valid group bit\"}");
-      return;
+      return result.fail(400, "group must be a single valid group bit");
     }
-    port->group = static_cast<uint8_t>(group);
   }
 
-  if (doc.containsKey("targetPortId")) {
-    long targetPortId = doc["targetPortId"];
-    if (targetPortId < 0 || targetPortId > 255) {
-      server.send(400, "application/json", "{\"error\":\"Invalid targetPortId\"}");
-      return;
+  long targetPortId = port->targetId;
+  if (args.containsKey("targetPortId")) {
+    targetPortId = args["targetPortId"];
+    if (targetPortId < 0 || targetPortId > TOPOLOGY_MAX_PORT_ID) {
+      return result.fail(400, "Invalid targetPortId");
     }
-    port->targetId = static_cast<uint8_t>(targetPortId);
   }
 
-  if (doc.containsKey("deviceMac")) {
-    uint8_t deviceMac[6] = {0};
-    if (!parseMacAddress(String(doc["deviceMac"].as<const char*>()), deviceMac)) {
-      server.send(400, "application/json", "{\"error\":\"Invalid deviceMac format\"}");
-      return;
-    }
+  uint8_t deviceMac[6] = {0};
+  const bool hasDeviceMac = args.containsKey("deviceMac");
+  if (hasDeviceMac && !parseMacAddress(String(args["deviceMac"].as<const char*>()), deviceMac)) {
+    return result.fail(400, "Invalid deviceMac format");
+  }
+
+  if (args.containsKey("direction")) {
+    port->direction = static_cast<bool>(args["direction"]);
+  }
+  port->group = static_cast<uint8_t>(group);
+  port->targetId = static_cast<TopologyPortId>(targetPortId);
+  if (hasDeviceMac) {
     for (uint8_t i = 0; i < 6; i++) {
       port->device[i] = deviceMac[i];
     }
   }
-
-  server.send(200, "application/json", "{\"success\":true}");
+  return true;
 }
 
-void handleRemoveExternalPort() {
+void handleUpdateExternalPort() {
   sendCORSHeaders("POST");
 
   if (!object) {
@@ -741,28 +865,35 @@ void handleRemoveExternalPort() {
   }
 
   String body = server.arg("plain");
-  DynamicJsonDocument doc(512);
+  DynamicJsonDocument doc(1024);
   DeserializationError error = deserializeJson(doc, body);
   if (error) {
     server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
     return;
   }
 
-  if (!doc.containsKey("portId")) {
-    server.send(400, "application/json", "{\"error\":\"Missing required parameter: portId\"}");
+  TopologyOpResult result;
+  if (!applyUpdateExternalPort(doc.as<JsonObjectConst>(), result)) {
+    sendTopologyOpError(result);
     return;
   }
 
-  long portId = doc["portId"];
-  if (portId < 0 || portId > 255) {
-    server.send(400, "application/json", "{\"error\":\"Invalid portId\"}");
-    return;
+  server.send(200, "application/json", "{\"success\":true}");
+}
+
+bool applyRemoveExternalPort(JsonObjectConst args, TopologyOpResult& result) {
+  if (!args.containsKey("portId")) {
+    return result.fail(400, "Missing required parameter: portId");
+  }
+
+  long portId = args["portId"];
+  if (portId < 0 || portId > TOPOLOGY_MAX_PORT_ID) {
+    return result.fail(400, "Invalid portId");
   }
 
-  Port* port = Port::findById(static_cast<uint8_t>(portId));
+  Port* port = Port::findById(static_cast<TopologyPortId>(portId));
   if (!port || !port->isExternal()) {
-    server.send(404, "application/json", "{\"error\":\"External port not found\"}");
-    return;
+    return result.fail(404, "External port not found");
   }
 
   for (Model* model : object->models) {
@@ -772,7 +903,30 @@ void handleRemoveExternalPort() {
   }
 
   if (!object->removeExternalPort(port)) {
-    server.send(500, "application/json", "{\"error\":\"Failed to remove external port\"}");
+    return result.fail(500, "Failed to remove external port");
+  }
+  return true;
+}
+
+void handleRemoveExternalPort() {
+  sendCORSHeaders("POST");
+
+  if (!object) {
+    server.send(404, "application/json", "{\"error\":\"No model object available\"}");
+    return;
+  }
+
+  String body = server.arg("plain");
+  DynamicJsonDocument doc(512);
+  DeserializationError error = deserializeJson(doc, body);
+  if (error) {
+    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+    return;
+  }
+
+  TopologyOpResult result;
+  if (!applyRemoveExternalPort(doc.as<JsonObjectConst>(), result)) {
+    sendTopologyOpError(result);
     return;
   }
 
@@ -849,7 +1003,7 @@ void handleCrossDevicePeers() {
 void handleCrossDeviceStatus() {
   sendCORSHeaders("GET");
 
-  DynamicJsonDocument doc(512);
+  DynamicJsonDocument doc(768);
   doc["enabled"] = isExternalTransportEnabled();
   doc["transport"] = externalTransportName();
   doc["runtimeState"] = externalTransportRuntimeStateName(externalTransportRuntimeState());
@@ -861,17 +1015,84 @@ void handleCrossDeviceStatus() {
   doc["lastError"] = externalTransportLastError();
   doc["lastErrorAtMs"] = externalTransportLastErrorAt();
 
+  #ifdef ESPNOW_ENABLED
+  JsonObject remoteLists = doc.createNestedObject("remoteListPool");
+  remoteLists["capacity"] = MAX_REMOTE_LIGHT_LISTS;
+  remoteLists["inUse"] = remoteLightListPoolInUse();
+  remoteLists["acquired"] = gRemoteLightListAcquired;
+  remoteLists["released"] = gRemoteLightListReleased;
+  remoteLists["rejected"] = gRemoteLightListRejected;
+  #endif
+
   String output;
   serializeJson(doc, output);
   server.send(200, "application/json", output);
 }
 
-// Get LED colors as JSON for visualization
-void handleGetColors() {
-  sendCORSHeaders("GET");
+// Isolates one layer for a read-only preview and restores the original
+// visibility/blend state when it goes out of scope. Restoring does not run
+// State::update() again; it marks the composite stale instead, so the next
+// updateLEDs() recomposes before drawing even when no fixed-step tick is due.
+struct LayerPreviewScope {
+  bool active = false;
+  bool recomposed = false;
+  uint8_t layer = 0;
+  bool savedVisible[MAX_LIGHT_LISTS] = {};
+  BlendMode savedBlendMode = BLEND_NORMAL;
+
+  bool begin(uint8_t requestedLayer) {
+    if (!state || !state->lightLists[requestedLayer]) {
+      return false;
+    }
 
-  // Use a stream-based approach to avoid building a large string in memory
-  WiFiClient client = server.client();
+    layer = requestedLayer;
+    bool changed = false;
+    for (uint8_t i = 0; i < MAX_LIGHT_LISTS; i++) {
+      LightList* list = state->lightLists[i];
+      if (!list) {
+        continue;
+      }
+      savedVisible[i] = list->visible;
+      const bool previewVisible = (i == requestedLayer);
+      changed = changed || list->visible != previewVisible;
+      list->visible = previewVisible;
+    }
+    savedBlendMode = state->lightLists[requestedLayer]->blendMode;
+    changed = changed || savedBlendMode != BLEND_NORMAL;
+    state->lightLists[requestedLayer]->blendMode = BLEND_NORMAL;
+    active = true;
+
+    if (changed) {
+      state->update();
+      recomposed = true;
+    }
+    return true;
+  }
+
+  ~LayerPreviewScope() {
+    if (!active || !state) {
+      return;
+    }
+    for (uint8_t i = 0; i < MAX_LIGHT_LISTS; i++) {
+      if (state->lightLists[i]) {
+        state->lightLists[i]->visible = savedVisible[i];
+      }
+    }
+    if (state->lightLists[layer]) {
+      state->lightLists[layer]->blendMode = savedBlendMode;
+    }
+    if (recomposed) {
+      stateCompositeStale = true;
+    }
+  }
+};
+
+// Get LED colors as JSON for visualization
+void handleGetColors() {
+  sendCORSHeaders("GET");
+
+  // Use a stream-based approach to avoid building a large string in memory
+  WiFiClient client = server.client();
 
   if (!client) {
     server.send(500, "text/plain", "Client connection error");
@@ -880,11 +1101,7 @@ void handleGetColors() {
 
   // Check if specific parameters are provided
   int maxColorParam = 0;
-  int specificLayer = -1;
-  bool toggledLayers = false;
-
-  std::vector<bool> originalVisibility;
-  BlendMode originalBlendMode;
+  LayerPreviewScope preview;
 
   if (server.hasArg("maxColors")) {
     maxColorParam = server.arg("maxColors").toInt();
@@ -896,36 +1113,10 @@ void handleGetColors() {
       server.send(400, "application/json", "{\"error\":\"Invalid layer index\"}");
       return;
     }
-    if (!state || !state->lightLists[requestedLayer]) {
+    if (!preview.begin(requestedLayer)) {
       server.send(400, "application/json", "{\"error\":\"Invalid layer index\"}");
       return;
     }
-
-    specificLayer = requestedLayer;
-
-    // Store original visibility states.
-    for (uint8_t i = 0; i < MAX_LIGHT_LISTS; i++) {
-      if (state->lightLists[i]) {
-        originalVisibility.push_back(state->lightLists[i]->visible);
-        // Disable all layers except the requested one.
-        if (i != requestedLayer) {
-          toggledLayers = toggledLayers || state->lightLists[i]->visible;
-          state->lightLists[i]->visible = false;
-        } else {
-          toggledLayers = toggledLayers || !state->lightLists[i]->visible;
-          state->lightLists[i]->visible = true;
-          originalBlendMode = state->lightLists[i]->blendMode;
-          state->lightLists[i]->blendMode = BLEND_NORMAL;
-        }
-      } else {
-        originalVisibility.push_back(false);
-      }
-    }
-
-    // Force a redraw to apply visibility changes.
-    if (toggledLayers) {
-      state->update();
-    }
   }
 
   // Send HTTP headers with CORS
@@ -945,7 +1136,7 @@ void handleGetColors() {
   int maxColors = maxColorParam > 0 ? maxColorParam : (freeHeap < 20000 ? 100 : (freeHeap < 40000 ? 200 : 300));
 
   int step = 1;
-  uint16_t totalPixels = pixelCount1 + pixelCount2;
+  uint16_t totalPixels = outputMap.totalPixels;
   if (totalPixels > maxColors) {
     step = (totalPixels + maxColors - 1) / maxColors; // Ceiling division
   }
@@ -954,13 +1145,15 @@ void handleGetColors() {
   int pixelsAdded = 0;
 
   #ifdef NEOPIXELBUS_ENABLED
-  if (ledLibrary == LIB_NEOPIXELBUS && strip1 != NULL) {
-    // Add colors from first strip
-    for (uint16_t i = 0; i < pixelCount1 && pixelsAdded < maxColors; i += step) {
+  if (ledLibrary == LIB_NEOPIXELBUS && strips[0] != NULL) {
+    for (uint16_t i = 0; i < totalPixels && pixelsAdded < maxColors; i += step) {
       if (pixelsAdded > 0) client.print(",");
 
-      // Get the pixel color
-      RgbwColor color = getNeoPixelColor(i);
+      // White extraction follows the colour order of the strip holding the pixel.
+      uint16_t localIndex = 0;
+      const int8_t stripIndex = outputMap.locate(i, localIndex);
+      const uint8_t order = stripIndex >= 0 ? outputMap.strips[stripIndex].colorOrder : colorOrder;
+      RgbwColor color = getNeoPixelColor(i, order);
 
       // Write JSON directly to client
       client.printf("{\"r\":%d,\"g\":%d,\"b\":%d,\"w\":%d}",
@@ -973,39 +1166,18 @@ void handleGetColors() {
         yield();
       }
     }
-
-    // Add colors from second strip if present
-    if (pixelCount2 > 0 && strip2 != NULL) {
-      for (uint16_t i = 0; i < pixelCount2 && pixelsAdded < maxColors; i += step) {
-        client.print(",");
-
-        // Get the pixel color
-        RgbwColor color = getNeoPixelColor(pixelCount1 + i);
-
-        // Write JSON directly to client
-        client.printf("{\"r\":%d,\"g\":%d,\"b\":%d,\"w\":%d}",
-                     color.R, color.G, color.B, color.W);
-
-        pixelsAdded++;
-
-        // Yield to prevent watchdog timer from triggering
-        if (pixelsAdded % 20 == 0) {
-          yield();
-        }
-      }
-    }
   }
   #endif
 
   #ifdef FASTLED_ENABLED
-  if (ledLibrary == LIB_FASTLED && leds1 != NULL) {
-    // Add colors from first strip
-    for (uint16_t i = 0; i < pixelCount1 && pixelsAdded < maxColors; i += step) {
+  if (ledLibrary == LIB_FASTLED && leds != NULL) {
+    for (uint16_t i = 0; i < totalPixels && pixelsAdded < maxColors; i += step) {
       if (pixelsAdded > 0) client.print(",");
 
-      // Write JSON directly to client
+      // The strip buffer holds the full composite; previews sample the state.
+      const CRGB color = preview.active ? getFastLEDColor(i) : leds[i];
       client.printf("{\"r\":%d,\"g\":%d,\"b\":%d,\"w\":0}",
-                   leds1[i].r, leds1[i].g, leds1[i].b);
+                   color.r, color.g, color.b);
 
       pixelsAdded++;
 
@@ -1014,22 +1186,33 @@ void handleGetColors() {
         yield();
       }
     }
+  }
+  #endif
 
-    // Add colors from second strip if present
-    if (pixelCount2 > 0 && leds2 != NULL) {
-      for (uint16_t i = 0; i < pixelCount2 && pixelsAdded < maxColors; i += step) {
-        client.print(",");
+  #ifdef VIRTUAL_LEDS_ENABLED
+  if (ledLibrary == LIB_VIRTUAL) {
+    for (uint16_t i = 0; i < totalPixels && pixelsAdded < maxColors; i += step) {
+      if (pixelsAdded > 0) client.print(",");
 
-        // Write JSON directly to client
-        client.printf("{\"r\":%d,\"g\":%d,\"b\":%d,\"w\":0}",
-                     leds2[i].r, leds2[i].g, leds2[i].b);
+      // Read back the captured frame so colour order handling shows up here too.
+      uint8_t r = 0, g = 0, b = 0, w = 0;
+      if (preview.active || !virtualOutput.readPixel(i, r, g, b, w)) {
+        uint16_t localIndex = 0;
+        const int8_t stripIndex = outputMap.locate(i, localIndex);
+        const uint8_t order = stripIndex >= 0 ? outputMap.strips[stripIndex].colorOrder : colorOrder;
+        const VirtualColor color = getVirtualLEDColor(i, order);
+        r = color.r;
+        g = color.g;
+        b = color.b;
+        w = color.w;
+      }
+      client.printf("{\"r\":%d,\"g\":%d,\"b\":%d,\"w\":%d}", r, g, b, w);
 
-        pixelsAdded++;
+      pixelsAdded++;
 
-        // Yield to prevent watchdog timer from triggering
-        if (pixelsAdded % 20 == 0) {
-          yield();
-        }
+      // Yield to prevent watchdog timer from triggering
+      if (pixelsAdded % 20 == 0) {
+        yield();
       }
     }
   }
@@ -1045,20 +1228,6 @@ void handleGetColors() {
 
   // Allow time for data to be sent
   delay(1);
-
-  // Restore original layer visibility if we modified it
-  if (toggledLayers && state) {
-    for (uint8_t i = 0; i < MAX_LIGHT_LISTS && i < originalVisibility.size(); i++) {
-      if (state->lightLists[i]) {
-        state->lightLists[i]->visible = originalVisibility[i];
-      }
-    }
-    if (specificLayer > -1 && specificLayer < MAX_LIGHT_LISTS && state->lightLists[specificLayer]) {
-      state->lightLists[specificLayer]->blendMode = originalBlendMode;
-    }
-    // Force a redraw to apply the restored visibility
-    state->update();
-  }
 }
 
 // Get LED model information as JSON
@@ -1214,244 +1383,306 @@ void handleGetModel() {
   delay(1);
 }
 
-bool parseBoundedLong(JsonVariantConst value, long minValue, long maxValue, long& out) {
-  const bool isNumber =
-      value.is<int>() || value.is<long>() || value.is<unsigned int>() || value.is<unsigned long>();
-  if (!isNumber) {
-    return false;
-  }
-  const long parsed = value.as<long>();
-  if (parsed < minValue || parsed > maxValue) {
-    return false;
+// Builds a TopologySnapshot from /import_topology JSON as JsonStreamReader walks
+// it. Each entry's fields are collected until its object closes and then checked
+// with the same bounds and messages as the single-edit routes.
+class TopologySnapshotJsonSink : public JsonStreamSink {
+ public:
+  TopologySnapshot snapshot;
+  String error;
+
+  void reset() override {
+    snapshot = TopologySnapshot();
+    error = "";
+    schemaVersion_.reset();
+    pixelCount_.reset();
+    hasIntersections_ = false;
+    hasConnections_ = false;
+    hasPorts_ = false;
+  }
+
+  bool onContainerStart(const JsonStreamPath& path, bool isArray) override {
+    if (path.depth() == 1 && isArray) {
+      hasIntersections_ |= path.is("intersections");
+      hasConnections_ |= path.is("connections");
+      hasPorts_ |= path.is("ports");
+      return true;
+    }
+    if (isArray) {
+      return true;
+    }
+    if (path.is("intersections[]") || path.is("connections[]") || path.is("ports[]") ||
+        path.is("gaps[]") || path.is("models[].weights[].conditionals[]")) {
+      entry_.reset();
+      deviceMac_[0] = '\0';
+      isExternal_ = false;
+      direction_ = false;
+    } else if (path.is("models[]")) {
+      model_.reset();
+      modelWeights_.clear();
+    } else if (path.is("models[].weights[]")) {
+      weight_.reset();
+      weightConditionals_.clear();
+    }
+    return true;
   }
-  out = parsed;
-  return true;
-}
 
-bool parseTopologySnapshotFromJson(JsonObjectConst root, TopologySnapshot& snapshot, String& error) {
-  long schemaVersion = 0;
-  if (!parseBoundedLong(root["schemaVersion"], 0, 255, schemaVersion)) {
-    error = "Missing schemaVersion";
-    return false;
-  }
-  if (schemaVersion != 2) {
-    error = "Unsupported schemaVersion; expected 2";
-    return false;
-  }
-  snapshot.schemaVersion = static_cast<uint8_t>(schemaVersion);
+  bool onValue(const JsonStreamPath& path, const JsonStreamValue& value) override {
+    const char* key = path.key();
+    if (path.depth() == 1) {
+      if (strcmp(key, "schemaVersion") == 0) {
+        schemaVersion_.set(0, value, 0, 255);
+      } else if (strcmp(key, "pixelCount") == 0) {
+        pixelCount_.set(0, value, 1, 65535);
+      }
+      return true;
+    }
 
-  long pixelCount = 0;
-  if (!parseBoundedLong(root["pixelCount"], 1, 65535, pixelCount)) {
-    error = "Invalid or missing pixelCount";
-    return false;
+    if (path.parentIs("intersections[]")) {
+      setField(key, value, {{"id", 0, TOPOLOGY_MAX_INTERSECTION_ID}, {"numPorts", 1, 8}, {"topPixel", 0, 65535},
+                            {"group", 1, 255}, {"bottomPixel", -1, 32767}});
+    } else if (path.parentIs("connections[]")) {
+      setField(key, value, {{"fromIntersectionId", 0, TOPOLOGY_MAX_INTERSECTION_ID},
+                            {"toIntersectionId", 0, TOPOLOGY_MAX_INTERSECTION_ID},
+                            {"group", 1, 255}, {"numLeds", 0, 65535}});
+    } else if (path.parentIs("ports[]")) {
+      if (strcmp(key, "type") == 0) {
+        isExternal_ = value.type == JsonStreamValue::Text && strcasecmp(value.text, "external") == 0;
+      } else if (strcmp(key, "direction") == 0) {
+        direction_ = value.toBool();
+      } else if (strcmp(key, "deviceMac") == 0) {
+        entry_.present |= PORT_HAS_MAC;
+        // Anything that does not fit is left empty so commitPort() rejects it.
+        const bool fits = value.type == JsonStreamValue::Text && strlen(value.text) < sizeof(deviceMac_);
+        strcpy(deviceMac_, fits ? value.text : "");
+      } else {
+        setField(key, value, {{"id", 0, TOPOLOGY_MAX_PORT_ID}, {"intersectionId", 0, TOPOLOGY_MAX_INTERSECTION_ID},
+                              {"slotIndex", 0, 255}, {"group", 1, 255}, {"targetPortId", 0, TOPOLOGY_MAX_PORT_ID}});
+      }
+    } else if (path.parentIs("models[]")) {
+      setField(model_, key, value, {{"id", 0, 255}, {"defaultWeight", 0, 255}, {"emitGroups", 0, 255},
+                                    {"maxLength", 0, 65535}, {"routingStrategy", 0, 1}});
+    } else if (path.parentIs("models[].weights[]")) {
+      setField(weight_, key, value, {{"outgoingPortId", 0, TOPOLOGY_MAX_PORT_ID}, {"defaultWeight", 0, 255}});
+    } else if (path.parentIs("models[].weights[].conditionals[]")) {
+      setField(key, value, {{"incomingPortId", 0, TOPOLOGY_MAX_PORT_ID}, {"weight", 0, 255}});
+    } else if (path.parentIs("gaps[]")) {
+      setField(key, value, {{"fromPixel", 0, 65535}, {"toPixel", 0, 65535}});
+    } else if (path.is("intersections[]") || path.is("connections[]") || path.is("ports[]") ||
+               path.is("models[]") || path.is("gaps[]")) {
+      return fail("Invalid topology entry");
+    }
+    return true;
   }
-  snapshot.pixelCount = static_cast<uint16_t>(pixelCount);
 
-  JsonArrayConst intersections = root["intersections"];
-  if (intersections.isNull()) {
-    error = "Missing intersections array";
-    return false;
-  }
-  for (JsonObjectConst intersectionJson : intersections) {
-    long id = 0;
-    long numPorts = 0;
-    long topPixel = 0;
-    long group = 0;
-    if (!parseBoundedLong(intersectionJson["id"], 0, 255, id) ||
-        !parseBoundedLong(intersectionJson["numPorts"], 1, 8, numPorts) ||
-        !parseBoundedLong(intersectionJson["topPixel"], 0, 65535, topPixel) ||
-        !parseBoundedLong(intersectionJson["group"], 1, 255, group)) {
-      error = "Invalid intersection entry";
-      return false;
+  bool onContainerEnd(const JsonStreamPath& path, bool isArray) override {
+    if (isArray) {
+      return true;
     }
-    long bottomPixel = -1;
-    if (!intersectionJson["bottomPixel"].isNull()) {
-      if (!parseBoundedLong(intersectionJson["bottomPixel"], -1, 32767, bottomPixel)) {
-        error = "Invalid intersection bottomPixel";
-        return false;
+    if (path.is("intersections[]")) {
+      if (!entry_.complete(0x0F) || (entry_.invalid & 0x0F)) {
+        return fail("Invalid intersection entry");
+      }
+      if (entry_.invalid & 0x10) {
+        return fail("Invalid intersection bottomPixel");
+      }
+      snapshot.intersections.push_back({
+        static_cast<TopologyIntersectionId>(entry_.values[0]),
+        static_cast<uint8_t>(entry_.values[1]),
+        static_cast<uint16_t>(entry_.values[2]),
+        static_cast<int16_t>(entry_.has(4) ? entry_.values[4] : -1),
+        static_cast<uint8_t>(entry_.values[3]),
+      });
+    } else if (path.is("connections[]")) {
+      if (!entry_.complete(0x0F) || entry_.invalid) {
+        return fail("Invalid connection entry");
       }
+      snapshot.connections.push_back({
+        static_cast<TopologyIntersectionId>(entry_.values[0]),
+        static_cast<TopologyIntersectionId>(entry_.values[1]),
+        static_cast<uint8_t>(entry_.values[2]),
+        static_cast<uint16_t>(entry_.values[3]),
+      });
+    } else if (path.is("ports[]")) {
+      return commitPort();
+    } else if (path.is("models[]")) {
+      if (!model_.complete(0x0F) || (model_.invalid & 0x0F)) {
+        return fail("Invalid model entry");
+      }
+      if (model_.invalid & 0x10) {
+        return fail("Invalid model routingStrategy");
+      }
+      snapshot.models.push_back({
+        static_cast<uint8_t>(model_.values[0]),
+        static_cast<uint8_t>(model_.values[1]),
+        static_cast<uint8_t>(model_.values[2]),
+        static_cast<uint16_t>(model_.values[3]),
+        static_cast<RoutingStrategy>(model_.has(4) ? model_.values[4] : 0),
+        std::move(modelWeights_),
+      });
+      modelWeights_.clear();
+    } else if (path.is("models[].weights[]")) {
+      if (!weight_.complete(0x03) || weight_.invalid) {
+        return fail("Invalid model weight entry");
+      }
+      modelWeights_.push_back({
+        static_cast<TopologyPortId>(weight_.values[0]),
+        static_cast<uint8_t>(weight_.values[1]),
+        std::move(weightConditionals_),
+      });
+      weightConditionals_.clear();
+    } else if (path.is("models[].weights[].conditionals[]")) {
+      if (!entry_.complete(0x03) || entry_.invalid) {
+        return fail("Invalid conditional model weight entry");
+      }
+      weightConditionals_.push_back({
+        static_cast<TopologyPortId>(entry_.values[0]),
+        static_cast<uint8_t>(entry_.values[1]),
+      });
+    } else if (path.is("gaps[]")) {
+      if (!entry_.complete(0x03) || entry_.invalid) {
+        return fail("Invalid gap entry");
+      }
+      snapshot.gaps.push_back({
+        static_cast<uint16_t>(entry_.values[0]),
+        static_cast<uint16_t>(entry_.values[1]),
+      });
     }
-    snapshot.intersections.push_back({
-      static_cast<uint8_t>(id),
-      static_cast<uint8_t>(numPorts),
-      static_cast<uint16_t>(topPixel),
-      static_cast<int16_t>(bottomPixel),
-      static_cast<uint8_t>(group),
-    });
+    return true;
   }
 
-  JsonArrayConst connections = root["connections"];
-  if (connections.isNull()) {
-    error = "Missing connections array";
-    return false;
-  }
-  for (JsonObjectConst connectionJson : connections) {
-    long fromIntersectionId = 0;
-    long toIntersectionId = 0;
-    long group = 0;
-    long numLeds = 0;
-    if (!parseBoundedLong(connectionJson["fromIntersectionId"], 0, 255, fromIntersectionId) ||
-        !parseBoundedLong(connectionJson["toIntersectionId"], 0, 255, toIntersectionId) ||
-        !parseBoundedLong(connectionJson["group"], 1, 255, group) ||
-        !parseBoundedLong(connectionJson["numLeds"], 0, 65535, numLeds)) {
-      error = "Invalid connection entry";
-      return false;
+  bool onDocumentEnd() override {
+    if (!schemaVersion_.complete(0x01) || schemaVersion_.invalid) {
+      return fail("Missing schemaVersion");
     }
-    snapshot.connections.push_back({
-      static_cast<uint8_t>(fromIntersectionId),
-      static_cast<uint8_t>(toIntersectionId),
-      static_cast<uint8_t>(group),
-      static_cast<uint16_t>(numLeds),
-    });
+    if (schemaVersion_.values[0] != 2) {
+      return fail("Unsupported schemaVersion; expected 2");
+    }
+    snapshot.schemaVersion = static_cast<uint8_t>(schemaVersion_.values[0]);
+    if (!pixelCount_.complete(0x01) || pixelCount_.invalid) {
+      return fail("Invalid or missing pixelCount");
+    }
+    snapshot.pixelCount = static_cast<uint16_t>(pixelCount_.values[0]);
+    if (!hasIntersections_) {
+      return fail("Missing intersections array");
+    }
+    if (!hasConnections_) {
+      return fail("Missing connections array");
+    }
+    if (!hasPorts_) {
+      return fail("Missing ports array");
+    }
+    return true;
   }
 
-  JsonArrayConst ports = root["ports"];
-  if (ports.isNull()) {
-    error = "Missing ports array";
-    return false;
+ private:
+  static constexpr uint8_t PORT_HAS_MAC = 0x80;
+
+  struct FieldBounds {
+    const char* key;
+    long minValue;
+    long maxValue;
+  };
+
+  // Values of the entry being read, indexed by their position in the field list.
+  struct PendingFields {
+    long values[5] = {};
+    uint8_t present = 0;
+    uint8_t invalid = 0;
+
+    void reset() {
+      present = 0;
+      invalid = 0;
+    }
+
+    bool has(uint8_t field) const { return present & (1 << field); }
+    bool complete(uint8_t mask) const { return (present & mask) == mask; }
+
+    // null leaves the field unset, so optional fields fall back to their default.
+    void set(uint8_t field, const JsonStreamValue& value, long minValue, long maxValue) {
+      if (value.isNull()) {
+        return;
+      }
+      if (value.toLong(minValue, maxValue, values[field])) {
+        present |= 1 << field;
+      } else {
+        invalid |= 1 << field;
+      }
+    }
+  };
+
+  void setField(const char* key, const JsonStreamValue& value, std::initializer_list<FieldBounds> fields) {
+    setField(entry_, key, value, fields);
   }
-  for (JsonObjectConst portJson : ports) {
-    long id = 0;
-    long intersectionId = 0;
-    long slotIndex = 0;
-    long group = 0;
-    if (!parseBoundedLong(portJson["id"], 0, 255, id) ||
-        !parseBoundedLong(portJson["intersectionId"], 0, 255, intersectionId) ||
-        !parseBoundedLong(portJson["slotIndex"], 0, 255, slotIndex) ||
-        !parseBoundedLong(portJson["group"], 1, 255, group)) {
-      error = "Invalid port entry";
-      return false;
+
+  static void setField(PendingFields& pending, const char* key, const JsonStreamValue& value,
+                       std::initializer_list<FieldBounds> fields) {
+    uint8_t field = 0;
+    for (const FieldBounds& bounds : fields) {
+      if (strcmp(key, bounds.key) == 0) {
+        pending.set(field, value, bounds.minValue, bounds.maxValue);
+        return;
+      }
+      field++;
     }
+  }
 
-    String type = String(portJson["type"] | "internal");
-    type.toLowerCase();
-    const TopologyPortType portType =
-        (type == "external") ? TopologyPortType::External : TopologyPortType::Internal;
-    const bool direction = portJson["direction"].isNull() ? false : portJson["direction"].as<bool>();
+  bool commitPort() {
+    if (!entry_.complete(0x0F) || (entry_.invalid & 0x0F)) {
+      return fail("Invalid port entry");
+    }
 
     std::array<uint8_t, 6> deviceMac = {0, 0, 0, 0, 0, 0};
     long targetPortId = 0;
-    if (portType == TopologyPortType::External) {
-      if (!portJson.containsKey("deviceMac")) {
-        error = "External port missing deviceMac";
-        return false;
+    if (isExternal_) {
+      if (!(entry_.present & PORT_HAS_MAC)) {
+        return fail("External port missing deviceMac");
       }
       uint8_t parsedMac[6] = {0};
-      if (!parseMacAddress(String(portJson["deviceMac"].as<const char*>()), parsedMac)) {
-        error = "Invalid external port deviceMac";
-        return false;
+      if (!parseMacAddress(String(deviceMac_), parsedMac)) {
+        return fail("Invalid external port deviceMac");
       }
       for (uint8_t i = 0; i < 6; i++) {
         deviceMac[i] = parsedMac[i];
       }
-      if (!parseBoundedLong(portJson["targetPortId"], 0, 255, targetPortId)) {
-        error = "Invalid external port targetPortId";
-        return false;
+      if (!entry_.has(4) || (entry_.invalid & 0x10)) {
+        return fail("Invalid external port targetPortId");
       }
+      targetPortId = entry_.values[4];
     }
 
     snapshot.ports.push_back({
-      static_cast<uint8_t>(id),
-      static_cast<uint8_t>(intersectionId),
-      static_cast<uint8_t>(slotIndex),
-      portType,
-      direction,
-      static_cast<uint8_t>(group),
+      static_cast<TopologyPortId>(entry_.values[0]),
+      static_cast<TopologyIntersectionId>(entry_.values[1]),
+      static_cast<uint8_t>(entry_.values[2]),
+      isExternal_ ? TopologyPortType::External : TopologyPortType::Internal,
+      direction_,
+      static_cast<uint8_t>(entry_.values[3]),
       deviceMac,
-      static_cast<uint8_t>(targetPortId),
+      static_cast<TopologyPortId>(targetPortId),
     });
+    return true;
   }
 
-  JsonArrayConst models = root["models"];
-  if (!models.isNull()) {
-    for (JsonObjectConst modelJson : models) {
-      long id = 0;
-      long defaultWeight = 0;
-      long emitGroups = 0;
-      long maxLength = 0;
-      long routingStrategy = 0;
-      if (!parseBoundedLong(modelJson["id"], 0, 255, id) ||
-          !parseBoundedLong(modelJson["defaultWeight"], 0, 255, defaultWeight) ||
-          !parseBoundedLong(modelJson["emitGroups"], 0, 255, emitGroups) ||
-          !parseBoundedLong(modelJson["maxLength"], 0, 65535, maxLength)) {
-        error = "Invalid model entry";
-        return false;
-      }
-      if (!modelJson["routingStrategy"].isNull() &&
-          !parseBoundedLong(modelJson["routingStrategy"], 0, 1, routingStrategy)) {
-        error = "Invalid model routingStrategy";
-        return false;
-      }
-
-      TopologyModelSnapshot modelSnapshot{
-        static_cast<uint8_t>(id),
-        static_cast<uint8_t>(defaultWeight),
-        static_cast<uint8_t>(emitGroups),
-        static_cast<uint16_t>(maxLength),
-        static_cast<RoutingStrategy>(routingStrategy),
-        {},
-      };
-
-      JsonArrayConst weights = modelJson["weights"];
-      if (!weights.isNull()) {
-        for (JsonObjectConst weightJson : weights) {
-          long outgoingPortId = 0;
-          long portDefaultWeight = 0;
-          if (!parseBoundedLong(weightJson["outgoingPortId"], 0, 255, outgoingPortId) ||
-              !parseBoundedLong(weightJson["defaultWeight"], 0, 255, portDefaultWeight)) {
-            error = "Invalid model weight entry";
-            return false;
-          }
-          TopologyPortWeightSnapshot weightSnapshot{
-            static_cast<uint8_t>(outgoingPortId),
-            static_cast<uint8_t>(portDefaultWeight),
-            {},
-          };
-
-          JsonArrayConst conditionals = weightJson["conditionals"];
-          if (!conditionals.isNull()) {
-            for (JsonObjectConst conditionalJson : conditionals) {
-              long incomingPortId = 0;
-              long conditionalWeight = 0;
-              if (!parseBoundedLong(conditionalJson["incomingPortId"], 0, 255, incomingPortId) ||
-                  !parseBoundedLong(conditionalJson["weight"], 0, 255, conditionalWeight)) {
-                error = "Invalid conditional model weight entry";
-                return false;
-              }
-              weightSnapshot.conditionals.push_back({
-                static_cast<uint8_t>(incomingPortId),
-                static_cast<uint8_t>(conditionalWeight),
-              });
-            }
-          }
-
-          modelSnapshot.weights.push_back(weightSnapshot);
-        }
-      }
-
-      snapshot.models.push_back(modelSnapshot);
-    }
-  }
-
-  JsonArrayConst gaps = root["gaps"];
-  if (!gaps.isNull()) {
-    for (JsonObjectConst gapJson : gaps) {
-      long fromPixel = 0;
-      long toPixel = 0;
-      if (!parseBoundedLong(gapJson["fromPixel"], 0, 65535, fromPixel) ||
-          !parseBoundedLong(gapJson["toPixel"], 0, 65535, toPixel)) {
-        error = "Invalid gap entry";
-        return false;
-      }
-      snapshot.gaps.push_back({
-        static_cast<uint16_t>(fromPixel),
-        static_cast<uint16_t>(toPixel),
-      });
-    }
+  bool fail(const char* message) {
+    error = message;
+    return false;
   }
 
-  return true;
-}
+  PendingFields schemaVersion_;
+  PendingFields pixelCount_;
+  PendingFields entry_;
+  PendingFields model_;
+  PendingFields weight_;
+  std::vector<TopologyPortWeightSnapshot> modelWeights_;
+  std::vector<TopologyWeightConditionalSnapshot> weightConditionals_;
+  char deviceMac_[18] = {};
+  bool isExternal_ = false;
+  bool direction_ = false;
+  bool hasIntersections_ = false;
+  bool hasConnections_ = false;
+  bool hasPorts_ = false;
+};
 
 void streamTopologySnapshot(const TopologySnapshot& snapshot) {
   WiFiClient client = server.client();
@@ -1563,6 +1794,33 @@ void streamTopologySnapshot(const TopologySnapshot& snapshot) {
   client.print("]}");
 }
 
+void streamTopologySnapshotBinary(const TopologySnapshot& snapshot) {
+  WiFiClient client = server.client();
+  if (!client) {
+    server.send(500, "text/plain", "Client connection error");
+    return;
+  }
+
+  client.println("HTTP/1.1 200 OK");
+  client.println("Content-Type: " TOPOLOGY_BINARY_CONTENT_TYPE);
+  client.printf("Content-Length: %u\r\n", static_cast<unsigned>(topologyBinarySize(snapshot)));
+  client.println("Access-Control-Allow-Origin: *");
+  client.println("Access-Control-Allow-Methods: GET, OPTIONS");
+  client.println("Access-Control-Allow-Headers: Content-Type, Authorization, X-Requested-With");
+  client.println("Connection: close");
+  client.println();
+
+  TopologyBinaryWriter writer(client);
+  writer.write(snapshot);
+}
+
+bool wantsBinaryTopology() {
+  if (server.arg("format") == "binary") {
+    return true;
+  }
+  return server.hasHeader("Accept") && server.header("Accept").indexOf(TOPOLOGY_BINARY_CONTENT_TYPE) >= 0;
+}
+
 void handleExportTopology() {
   sendCORSHeaders("GET");
 
@@ -1571,36 +1829,94 @@ void handleExportTopology() {
     return;
   }
 
+  if (wantsBinaryTopology()) {
+    streamTopologySnapshotBinary(object->exportSnapshot());
+    return;
+  }
   streamTopologySnapshot(object->exportSnapshot());
 }
 
+#ifndef TOPOLOGY_IMPORT_MAX_BYTES
+#define TOPOLOGY_IMPORT_MAX_BYTES 65536
+#endif
+
+// /import_topology reads its body through the raw upload callback: binary
+// snapshots go to the record decoder and JSON to gJsonRequestReader, so neither
+// is held in a String before parsing.
+TopologyBinaryDecoder gTopologyImportDecoder;
+TopologySnapshotJsonSink gTopologyImportSink;
+bool gTopologyImportBinary = false;
+bool gTopologyImportTooLarge = false;
+
+void resetTopologyImportUpload() {
+  gTopologyImportDecoder.reset();
+  gTopologyImportBinary = false;
+  gTopologyImportTooLarge = false;
+}
+
+void handleImportTopologyUpload() {
+  HTTPRaw& raw = server.raw();
+  if (raw.status == RAW_START) {
+    gTopologyImportBinary = server.hasHeader("Content-Type") &&
+                            server.header("Content-Type").startsWith(TOPOLOGY_BINARY_CONTENT_TYPE);
+    gTopologyImportTooLarge = false;
+    gTopologyImportDecoder.reset();
+  }
+  if (!gTopologyImportBinary) {
+    streamRawJsonBody(gTopologyImportSink, TOPOLOGY_IMPORT_MAX_BYTES);
+    return;
+  }
+  if (raw.status == RAW_WRITE) {
+    if (gTopologyImportTooLarge || raw.totalSize > TOPOLOGY_IMPORT_MAX_BYTES) {
+      gTopologyImportTooLarge = true;
+      return;
+    }
+    gTopologyImportDecoder.feed(raw.buf, raw.currentSize);
+  } else if (raw.status == RAW_ABORTED) {
+    gTopologyImportDecoder.reset();
+  }
+}
+
 void handleImportTopology() {
   sendCORSHeaders("POST");
 
   if (!object) {
+    discardRequestBody();
     server.send(404, "application/json", "{\"error\":\"No model object available\"}");
     return;
   }
 
-  String body = server.arg("plain");
-  if (body.length() == 0) {
-    server.send(400, "application/json", "{\"error\":\"Missing JSON payload\"}");
-    return;
-  }
-
-  const size_t docCapacity = std::max<size_t>(8192, body.length() * 2);
-  DynamicJsonDocument doc(docCapacity);
-  const DeserializationError parseError = deserializeJson(doc, body);
-  if (parseError) {
-    server.send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-    return;
-  }
+  const bool binary = gTopologyImportBinary;
+  gTopologyImportBinary = false;
 
   TopologySnapshot snapshot;
-  String validationError;
-  if (!parseTopologySnapshotFromJson(doc.as<JsonObjectConst>(), snapshot, validationError)) {
-    server.send(400, "application/json", "{\"error\":\"" + validationError + "\"}");
-    return;
+  if (binary) {
+    const bool tooLarge = gTopologyImportTooLarge;
+    gTopologyImportTooLarge = false;
+    if (tooLarge) {
+      gTopologyImportDecoder.reset();
+      server.send(413, "application/json", "{\"error\":\"Topology payload too large\"}");
+      return;
+    }
+    if (gTopologyImportDecoder.failed()) {
+      server.send(400, "application/json", "{\"error\":\"" + gTopologyImportDecoder.error() + "\"}");
+      gTopologyImportDecoder.reset();
+      return;
+    }
+    if (!gTopologyImportDecoder.finished()) {
+      server.send(400, "application/json", "{\"error\":\"Truncated binary topology snapshot\"}");
+      gTopologyImportDecoder.reset();
+      return;
+    }
+    snapshot = std::move(gTopologyImportDecoder.snapshot);
+    gTopologyImportDecoder.reset();
+  } else {
+    if (!finishJsonRequestBody(gTopologyImportSink, gTopologyImportSink.error, TOPOLOGY_IMPORT_MAX_BYTES)) {
+      gTopologyImportSink.reset();
+      return;
+    }
+    snapshot = std::move(gTopologyImportSink.snapshot);
+    gTopologyImportSink.reset();
   }
 
   if (!object->importSnapshot(snapshot, true)) {
@@ -1608,20 +1924,7 @@ void handleImportTopology() {
     return;
   }
 
-  if (state != nullptr) {
-    delete state;
-    state = nullptr;
-  }
-  state = new State(*object);
-  State::autoParams.from = emitterFrom;
-  state->autoEnabled = emitterEnabled;
-
-  #ifdef DEBUGGER_ENABLED
-  if (debugger != nullptr) {
-    delete debugger;
-  }
-  debugger = new Debugger(*object);
-  #endif
+  swapRuntimeState();
 
   server.send(
       200,
@@ -1629,6 +1932,207 @@ void handleImportTopology() {
       "{\"success\":true,\"intersectionCount\":" + String(snapshot.intersections.size()) +
           ",\"connectionCount\":" + String(snapshot.connections.size()) + "}");
 }
+
+// One op of a /topology_transaction batch as read from the body: the op name and
+// the fields the single-edit routes take. Each op is turned back into a small
+// JSON object when it is applied, so the apply* helpers stay shared.
+struct TopologyTransactionOp {
+  static constexpr uint8_t FIELD_COUNT = 10;
+  static constexpr const char* FIELDS[FIELD_COUNT] = {
+      "numPorts", "topPixel", "bottomPixel", "group", "id",
+      "intersectionId", "slotIndex", "targetPortId", "portId", "direction"};
+
+  char type[24] = {};
+  long values[FIELD_COUNT] = {};
+  uint16_t present = 0;
+  bool hasDeviceMac = false;
+  // "XX:XX:XX:XX:XX:XX"; longer values are kept empty so parseMacAddress() rejects them.
+  char deviceMac[18] = {};
+
+  static int8_t fieldIndex(const char* key) {
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+      if (strcmp(key, FIELDS[i]) == 0) {
+        return static_cast<int8_t>(i);
+      }
+    }
+    return -1;
+  }
+
+  void toJson(JsonDocument& doc) const {
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+      if (present & (1 << i)) {
+        doc[FIELDS[i]] = values[i];
+      }
+    }
+    if (hasDeviceMac) {
+      doc["deviceMac"] = static_cast<const char*>(deviceMac);
+    }
+  }
+};
+
+class TopologyTransactionSink : public JsonStreamSink {
+ public:
+  std::vector<TopologyTransactionOp> ops;
+  String error;
+
+  void reset() override {
+    ops.clear();
+    ops.shrink_to_fit();
+    error = "";
+    hasOps_ = false;
+  }
+
+  bool onContainerStart(const JsonStreamPath& path, bool isArray) override {
+    if (isArray && path.is("ops")) {
+      hasOps_ = true;
+    } else if (!isArray && path.is("ops[]")) {
+      if (ops.size() >= TOPOLOGY_TRANSACTION_MAX_OPS) {
+        return fail("Too many ops (max " + String(TOPOLOGY_TRANSACTION_MAX_OPS) + ")");
+      }
+      ops.emplace_back();
+    }
+    return true;
+  }
+
+  bool onValue(const JsonStreamPath& path, const JsonStreamValue& value) override {
+    if (!path.parentIs("ops[]")) {
+      if (path.is("ops[]")) {
+        return fail("Invalid op entry");
+      }
+      return true;
+    }
+    TopologyTransactionOp& op = ops.back();
+    const char* key = path.key();
+    if (strcmp(key, "op") == 0) {
+      if (value.type == JsonStreamValue::Text && strlen(value.text) < sizeof(op.type)) {
+        strcpy(op.type, value.text);
+      }
+      return true;
+    }
+    if (strcmp(key, "deviceMac") == 0) {
+      op.hasDeviceMac = true;
+      const bool fits = value.type == JsonStreamValue::Text && strlen(value.text) < sizeof(op.deviceMac);
+      strcpy(op.deviceMac, fits ? value.text : "");
+      return true;
+    }
+    const int8_t field = TopologyTransactionOp::fieldIndex(key);
+    if (field < 0 || value.isNull()) {
+      return true;
+    }
+    long number = 0;
+    if (value.type == JsonStreamValue::Bool) {
+      number = value.boolean ? 1 : 0;
+    } else if (!value.toLong(LONG_MIN, LONG_MAX, number)) {
+      return fail(String("Invalid ") + key);
+    }
+    op.values[field] = number;
+    op.present |= 1 << field;
+    return true;
+  }
+
+  bool onDocumentEnd() override {
+    if (!hasOps_ || ops.empty()) {
+      return fail("Missing required parameter: ops");
+    }
+    return true;
+  }
+
+ private:
+  bool fail(const String& message) {
+    error = message;
+    return false;
+  }
+
+  bool hasOps_ = false;
+};
+
+TopologyTransactionSink gTopologyTransactionSink;
+
+void handleTopologyTransactionUpload() {
+  streamRawJsonBody(gTopologyTransactionSink, TOPOLOGY_TRANSACTION_MAX_BYTES);
+}
+
+// Applies a batch of topology edits atomically:
+//   {"ops":[{"op":"add_intersection",...},{"op":"remove_external_port",...}]}
+// Each op takes the same fields as its single-edit route. The body is read as it
+// arrives (handleTopologyTransactionUpload), so only the parsed ops are held.
+// Connections are recalculated once after the last op and State is rebuilt
+// when the graph changed; if any op fails, the topology captured before the
+// batch is restored and nothing is kept.
+void handleTopologyTransaction() {
+  sendCORSHeaders("POST");
+
+  if (!object) {
+    discardRequestBody();
+    server.send(404, "application/json", "{\"error\":\"No model object available\"}");
+    return;
+  }
+
+  if (!finishJsonRequestBody(gTopologyTransactionSink, gTopologyTransactionSink.error,
+                             TOPOLOGY_TRANSACTION_MAX_BYTES)) {
+    gTopologyTransactionSink.reset();
+    return;
+  }
+  const std::vector<TopologyTransactionOp> ops = std::move(gTopologyTransactionSink.ops);
+  gTopologyTransactionSink.reset();
+
+  const TopologySnapshot backup = object->exportSnapshot();
+  bool intersectionsChanged = false;
+  bool structureChanged = false;
+  String ids = "[";
+  size_t index = 0;
+  for (const TopologyTransactionOp& op : ops) {
+    StaticJsonDocument<384> args;
+    op.toJson(args);
+    const char* type = op.type;
+    TopologyOpResult result;
+    bool applied = false;
+    if (strcmp(type, "add_intersection") == 0) {
+      applied = applyAddIntersection(args.as<JsonObjectConst>(), result);
+      intersectionsChanged = true;
+    } else if (strcmp(type, "remove_intersection") == 0) {
+      applied = applyRemoveIntersection(args.as<JsonObjectConst>(), result);
+      intersectionsChanged = true;
+    } else if (strcmp(type, "add_external_port") == 0) {
+      applied = applyAddExternalPort(args.as<JsonObjectConst>(), result);
+      structureChanged = true;
+    } else if (strcmp(type, "update_external_port") == 0) {
+      applied = applyUpdateExternalPort(args.as<JsonObjectConst>(), result);
+    } else if (strcmp(type, "remove_external_port") == 0) {
+      applied = applyRemoveExternalPort(args.as<JsonObjectConst>(), result);
+      structureChanged = true;
+    } else {
+      result.fail(400, "Unknown op");
+    }
+
+    if (!applied) {
+      const bool rolledBack = object->importSnapshot(backup, true);
+      swapRuntimeState();
+      LP_LOGF("Topology transaction failed at op %d (%s): %s\n", static_cast<int>(index), type, result.error.c_str());
+      server.send(result.status, "application/json",
+                  "{\"error\":\"" + result.error + "\",\"failedOp\":" + String(index) +
+                      ",\"rolledBack\":" + String(rolledBack ? "true" : "false") + "}");
+      return;
+    }
+
+    if (index > 0) ids += ",";
+    ids += result.id >= 0 ? String(result.id) : String("null");
+    index++;
+  }
+  ids += "]";
+
+  if (intersectionsChanged) {
+    recalculateConnections();
+  }
+  // Running lights hold pointers into the graph the ops just changed.
+  if (intersectionsChanged || structureChanged) {
+    swapRuntimeState();
+  }
+
+  server.send(200, "application/json",
+              "{\"success\":true,\"applied\":" + String(index) + ",\"ids\":" + ids + "}");
+}
+
 #ifdef DEBUGGER_ENABLED
 // Handler for State::debug()
 void handleStateDebug() {
@@ -1676,6 +2180,57 @@ void handleTriggerCrash() {
 }
 #endif
 
+#if defined(TRACE_ENABLED) && defined(SPIFFS_ENABLED)
+void sendTraceStatus() {
+  DynamicJsonDocument doc(256);
+  doc["active"] = isTraceActive();
+  doc["seed"] = gTraceSeed;
+  doc["records"] = gTraceRecords;
+  doc["bytes"] = gTraceBytes;
+  doc["dropped"] = gTraceDropped;
+  doc["maxBytes"] = TRACE_MAX_BYTES;
+  String response;
+  serializeJson(doc, response);
+  server.send(200, "application/json", response);
+}
+
+void handleTraceStart() {
+  sendCORSHeaders("POST");
+  if (!startTrace(objectType, outputMap.totalPixels)) {
+    server.send(500, "application/json", "{\"success\":false,\"error\":\"trace_open_failed\"}");
+    return;
+  }
+  sendTraceStatus();
+}
+
+void handleTraceStop() {
+  sendCORSHeaders("POST");
+  stopTrace();
+  sendTraceStatus();
+}
+
+void handleTraceStatus() {
+  sendCORSHeaders("GET");
+  sendTraceStatus();
+}
+
+void handleTraceDownload() {
+  sendCORSHeaders("GET");
+  if (isTraceActive()) {
+    server.send(409, "application/json", "{\"success\":false,\"error\":\"trace_active\"}");
+    return;
+  }
+  File file = SPIFFS.open(TRACE_FILE, FILE_READ);
+  if (!file) {
+    server.send(404, "application/json", "{\"success\":false,\"error\":\"trace_not_found\"}");
+    return;
+  }
+  server.sendHeader("Content-Disposition", "attachment; filename=trace.bin");
+  server.streamFile(file, "application/octet-stream");
+  file.close();
+}
+#endif
+
 // Simple icon handler for WLED app compatibility
 void handleIcon() {
   // Unfortunately we don't have an icon, so just return 404
@@ -1720,7 +2275,7 @@ void handleGetDevices() {
 void handleOtaStatus() {
   sendCORSHeaders("GET");
 
-  DynamicJsonDocument doc(2048);
+  DynamicJsonDocument doc(3072);
   JsonObject root = doc.to<JsonObject>();
   root["meshledVersion"] = getResolvedMeshledVersion();
   root["meshledCommitSha"] = getResolvedMeshledCommitSha();
@@ -1728,8 +2283,44 @@ void handleOtaStatus() {
   root["meshledReleaseSha"] = getResolvedMeshledReleaseSha();
   root["uptimeSec"] = millis() / 1000;
   root["freeHeap"] = ESP.getFreeHeap();
+  root["maxAllocHeap"] = ESP.getMaxAllocHeap();
   root["sketchMD5"] = ESP.getSketchMD5();
 
+  JsonObject output = root.createNestedObject("output");
+  output["framesComposed"] = gOutputFramesComposed;
+  output["framesSkipped"] = gOutputFramesSkipped;
+  output["showsSkipped"] = gOutputShowsSkipped;
+  output["refreshMs"] = outputRefreshMs;
+  output["simTickHz"] = simTickHz;
+  output["simDroppedTicks"] = simDroppedTicks;
+#ifdef VIRTUAL_LEDS_ENABLED
+  if (ledLibrary == LIB_VIRTUAL) {
+    JsonObject virtualLeds = output.createNestedObject("virtual");
+    virtualLeds["frames"] = virtualOutput.frames;
+    virtualLeds["frameBytes"] = virtualOutput.frameBytes();
+    virtualLeds["frameMicros"] = virtualOutput.frameMicros();
+    virtualLeds["wireMicros"] = virtualOutput.totalWireMicros;
+    virtualLeds["blockedMicros"] = virtualOutput.blockedMicros;
+  }
+#endif
+
+#ifdef ALLOC_ACCOUNTING_ENABLED
+  JsonObject alloc = root.createNestedObject("alloc");
+  for (uint8_t i = 0; i < ALLOC_PHASE_COUNT; i++) {
+    const AllocPhaseStats& stats = gAllocPhaseStats[i];
+    JsonObject phase = alloc.createNestedObject(allocPhaseName(i));
+    phase["calls"] = stats.calls;
+    phase["callsWithAllocs"] = stats.callsWithAllocs;
+    phase["allocs"] = stats.allocs;
+    phase["frees"] = stats.frees;
+    phase["bytes"] = stats.bytes;
+    phase["netBytes"] = stats.netBytes;
+    phase["maxAllocsPerCall"] = stats.maxAllocsPerCall;
+    phase["lastAllocs"] = stats.lastAllocs;
+    phase["lastNetBytes"] = stats.lastNetBytes;
+  }
+#endif
+
 #if MESHLED_HAS_RESET_REASON
   const esp_reset_reason_t resetReason = esp_reset_reason();
   root["resetReasonCode"] = static_cast<int>(resetReason);
@@ -1784,8 +2375,8 @@ std::function<void(void)> allowCORS(const String& methods) {
 #include "WebRoutesWLED.h"
 
 void setupWebServer() {
-  static const char* headerKeys[] = {"Authorization", "X-API-Token"};
-  server.collectHeaders(headerKeys, 2);
+  static const char* headerKeys[] = {"Authorization", "X-API-Token", "Accept", "Content-Type"};
+  server.collectHeaders(headerKeys, 4);
 
   registerBaseRoutes(server, gCtx);
   registerLayerRoutes(server, gCtx);
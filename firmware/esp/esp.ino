@@ -16,8 +16,10 @@
 // #define BLUETOOTH_ENABLED
 // #define SERIAL_ENABLED   // Serial commands
 // #define DEBUGGER_ENABLED // Debugging features
+// #define TRACE_ENABLED // Record OSC/HTTP/command input traces for host replay (requires SPIFFS)
 #define NEOPIXELBUS_ENABLED
 // #define FASTLED_ENABLED
+// #define VIRTUAL_LEDS_ENABLED // Capture frames in memory instead of driving strips (profiling/host testing)
 #define WLEDAPI_ENABLED
 #define SSDP_ENABLED
 #define MDNS_ENABLED
@@ -54,6 +56,9 @@
 #include "LightGraph.h"
 #include "FirmwareContext.h"
 #include "ExternalTransport.h"
+#include "OutputFrameGate.h"
+#include "TraceRecorder.h"
+#include "AllocAccounting.h"
 
 FirmwareContext gCtx = []() {
   FirmwareContext ctx;
@@ -74,11 +79,15 @@ uint8_t& maxBrightness = gCtx.maxBrightness;
 uint8_t& ledType = gCtx.ledType;
 uint8_t& ledLibrary = gCtx.ledLibrary;
 uint8_t& colorOrder = gCtx.colorOrder;
-uint16_t& pixelCount1 = gCtx.pixelCount1;
-uint16_t& pixelCount2 = gCtx.pixelCount2;
-uint8_t& pixelPin1 = gCtx.pixelPin1;
-uint8_t& pixelPin2 = gCtx.pixelPin2;
+OutputStripConfig (&outputs)[OUTPUT_MAX_STRIPS] = gCtx.outputs;
+OutputMap& outputMap = gCtx.outputMap;
+uint16_t& pixelCount1 = gCtx.outputs[0].pixelCount;
+uint16_t& pixelCount2 = gCtx.outputs[1].pixelCount;
+uint8_t& pixelPin1 = gCtx.outputs[0].pin;
+uint8_t& pixelPin2 = gCtx.outputs[1].pin;
 uint8_t& pixelDensity = gCtx.pixelDensity;
+uint16_t& outputRefreshMs = gCtx.outputRefreshMs;
+uint16_t& simTickHz = gCtx.simTickHz;
 bool& oscEnabled = gCtx.oscEnabled;
 uint16_t& oscPort = gCtx.oscPort;
 bool& otaEnabled = gCtx.otaEnabled;
@@ -136,6 +145,8 @@ String getActiveNetworkSSID() {
   return "";
 }
 
+#include "LayerConfig.h"
+
 #ifdef SPIFFS_ENABLED
 #include <ArduinoJson.h>
 #include "SecurityLib.h"
@@ -225,6 +236,7 @@ WebServer server(80);
 
 void setup() {
   Serial.begin(115200);
+  initAllocAccounting();
   LP_LOGLN("MeshLED starting up...");
 
   #ifdef SPIFFS_ENABLED
@@ -300,6 +312,7 @@ void loop() {
 
   updateLEDs();
   drawLEDs();
+  flushTrace();
 
   #ifdef SERIAL_ENABLED
   readSerial();
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal check macros for the firmware host tests: failures are printed and
+// counted, and main() returns HOST_TEST_RESULT() so ctest sees them.
+
+inline int& hostTestFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(condition)                                                      \
+  do {                                                                        \
+    if (!(condition)) {                                                       \
+      std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      hostTestFailures()++;                                                   \
+    }                                                                         \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                    \
+  do {                                                                                \
+    const long long actualValue = static_cast<long long>(actual);                     \
+    const long long expectedValue = static_cast<long long>(expected);                 \
+    if (actualValue != expectedValue) {                                               \
+      std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+                  #actual, #expected, actualValue, expectedValue);                    \
+      hostTestFailures()++;                                                           \
+    }                                                                                 \
+  } while (0)
+
+#define HOST_TEST_RESULT()                                                 \
+  (hostTestFailures() == 0 ? (std::printf("ok\n"), 0)                      \
+                           : (std::printf("%d failure(s)\n", hostTestFailures()), 1))
@@ -0,0 +1,138 @@
+// Auto-connect benchmark: ConnectionPlanner on groups of 500 to 8000
+// intersections, every one with a bottomPixel (the case the old all-pairs scan
+// handled worst), against that scan at the smallest size. Times are printed
+// for reference; the check is on the number of intersections the walks visit,
+// which must stay linear in the group size.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ConnectionPlanner.h"
+#include "HostTest.h"
+
+namespace {
+
+struct BenchIntersection {
+  uint16_t topPixel = 0;
+  int16_t bottomPixel = -1;
+  uint8_t numPorts = 4;
+  uint8_t used = 0;
+};
+
+bool hasPort(const BenchIntersection* intersection) { return intersection->used < intersection->numPorts; }
+
+// A grid walked by one strip twice: first along the rows (topPixel), then along
+// the columns (bottomPixel), both serpentine, with `spacing` pixels between
+// crossings. Every crossing is a 4-port intersection with both pixels.
+std::vector<BenchIntersection> gridLayout(int side, int spacing) {
+  std::vector<BenchIntersection> grid(static_cast<size_t>(side) * side);
+  int pixel = 0;
+  for (int row = 0; row < side; row++) {
+    for (int step = 0; step < side; step++) {
+      const int column = row % 2 ? side - 1 - step : step;
+      grid[row * side + column].topPixel = static_cast<uint16_t>(pixel);
+      pixel += spacing;
+    }
+  }
+  for (int column = 0; column < side; column++) {
+    for (int step = 0; step < side; step++) {
+      const int row = column % 2 ? side - 1 - step : step;
+      grid[row * side + column].bottomPixel = static_cast<int16_t>(pixel);
+      pixel += spacing;
+    }
+  }
+  return grid;
+}
+
+// Crossings at random places along the strip, half of them 2-port.
+std::vector<BenchIntersection> randomLayout(size_t count, unsigned seed) {
+  std::srand(seed);
+  std::vector<BenchIntersection> layout(count);
+  for (size_t i = 0; i < count; i++) {
+    layout[i].topPixel = static_cast<uint16_t>(i * 4);
+    layout[i].bottomPixel = static_cast<int16_t>(std::rand() % 30000);
+    layout[i].numPorts = std::rand() % 2 ? 4 : 2;
+  }
+  return layout;
+}
+
+std::vector<BenchIntersection*> pointers(std::vector<BenchIntersection>& layout) {
+  std::vector<BenchIntersection*> members;
+  for (BenchIntersection& intersection : layout) {
+    members.push_back(&intersection);
+  }
+  return members;
+}
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The pre-planner scan: every pair, each with its own between-check.
+size_t allPairsScan(std::vector<BenchIntersection*> members) {
+  size_t made = 0;
+  for (size_t i = 0; i < members.size(); i++) {
+    for (size_t j = i + 1; j < members.size(); j++) {
+      BenchIntersection* a = members[i];
+      BenchIntersection* b = members[j];
+      bool blocked = false;
+      for (const BenchIntersection* test : members) {
+        if (test == a || test == b || test->topPixel <= a->topPixel || test->topPixel >= b->topPixel) continue;
+        const int low = std::min(a->bottomPixel, b->bottomPixel);
+        const int high = std::max(a->bottomPixel, b->bottomPixel);
+        if (test->bottomPixel > low && test->bottomPixel < high) {
+          blocked = true;
+          break;
+        }
+      }
+      if (!blocked && hasPort(a) && hasPort(b)) {
+        a->used++;
+        b->used++;
+        made++;
+      }
+    }
+  }
+  return made;
+}
+
+size_t plan(const char* name, std::vector<BenchIntersection> layout) {
+  std::vector<BenchIntersection*> members = pointers(layout);
+  ConnectionPlannerStats stats;
+  ConnectionPlanner planner;
+  planner.stats = &stats;
+  size_t made = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  planner.planGroup(members, hasPort, [&](BenchIntersection* a, BenchIntersection* b) {
+    a->used++;
+    b->used++;
+    made++;
+  });
+  const double elapsed = millisSince(start);
+
+  std::printf("%-8s n=%-5zu connections=%-6zu visited=%-6u %.2f ms\n", name, layout.size(), made, stats.visited,
+              elapsed);
+  CHECK(stats.visited <= 8 * layout.size());
+  return made;
+}
+
+}  // namespace
+
+int main() {
+  for (int side : {23, 45, 90}) {
+    plan("grid", gridLayout(side, 2));
+  }
+  for (size_t count : {500, 2000, 8000}) {
+    plan("random", randomLayout(count, static_cast<unsigned>(count)));
+  }
+
+  std::vector<BenchIntersection> reference = randomLayout(500, 500);
+  const auto start = std::chrono::steady_clock::now();
+  const size_t made = allPairsScan(pointers(reference));
+  std::printf("all-pairs scan n=500 connections=%zu %.2f ms\n", made, millisSince(start));
+  CHECK_EQ(made, plan("random", randomLayout(500, 500)));
+
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,106 @@
+// Host-side zero-allocation check for the per-frame output path and the
+// streaming body reader. The firmware counts heap traffic per loop phase with
+// ALLOC_ACCOUNTING_ENABLED; this runs the same code on the host with a counting
+// operator new so a regression fails in CI instead of on a device.
+
+#include <cstdlib>
+#include <new>
+
+#include "HostTest.h"
+#include "JsonStreamReader.h"
+#include "OutputMap.h"
+#include "VirtualOutput.h"
+
+static unsigned long gAllocations = 0;
+
+void* operator new(size_t size) {
+  gAllocations++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct CountingSink : JsonStreamSink {
+  unsigned values = 0;
+  long sum = 0;
+
+  void reset() override {
+    values = 0;
+    sum = 0;
+  }
+
+  bool onValue(const JsonStreamPath& path, const JsonStreamValue& value) override {
+    long number = 0;
+    if (path.is("colors[]") && value.toLong(0, 0xFFFFFF, number)) {
+      sum += number;
+    }
+    values++;
+    return true;
+  }
+};
+
+void outputFramesDoNotAllocate() {
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  configs[0].pixelCount = 300;
+  configs[1].pixelCount = 144;
+  configs[1].colorOrder = CO_GRBW;
+  configs[3].pixelCount = 60;
+
+  OutputMap map;
+  VirtualStripTiming timings[OUTPUT_MAX_STRIPS];
+  VirtualOutput output;
+  map.build(configs, 0, CO_GRB);
+  output.configure(map, timings);
+
+  const unsigned long before = gAllocations;
+  uint64_t now = 0;
+  for (int frame = 0; frame < 100; frame++) {
+    map.build(configs, 0, CO_GRB);
+    for (uint16_t pixel = 0; pixel < map.totalPixels; pixel++) {
+      uint16_t local = 0;
+      const int8_t strip = map.locate(pixel, local);
+      output.setPixel(static_cast<uint8_t>(strip), local, pixel & 0xFF, frame & 0xFF, 7, 1);
+    }
+    output.show(now);
+    now += 16000;
+  }
+  CHECK_EQ(gAllocations - before, 0);
+  CHECK_EQ(output.frames, 100);
+}
+
+void streamingReadDoesNotAllocate() {
+  static const char body[] =
+      "{\"name\":\"Sunset\",\"colors\":[16711680, 65280, 255],"
+      "\"positions\":[0,0.5,1],\"nested\":{\"a\":[true,false,null]}}";
+  CountingSink sink;
+  JsonStreamReader reader;
+
+  const unsigned long before = gAllocations;
+  for (int request = 0; request < 50; request++) {
+    sink.reset();
+    reader.begin(&sink, sizeof(body));
+    // Feed in small chunks, the way request bodies arrive.
+    for (size_t offset = 0; offset < sizeof(body) - 1; offset += 7) {
+      const size_t length = sizeof(body) - 1 - offset < 7 ? sizeof(body) - 1 - offset : 7;
+      reader.feed(body + offset, length);
+    }
+    CHECK(reader.finish());
+  }
+  CHECK_EQ(gAllocations - before, 0);
+  CHECK_EQ(sink.values, 10);
+  CHECK_EQ(sink.sum, 16711680 + 65280 + 255);
+}
+
+}  // namespace
+
+int main() {
+  outputFramesDoNotAllocate();
+  streamingReadDoesNotAllocate();
+  return HOST_TEST_RESULT();
+}
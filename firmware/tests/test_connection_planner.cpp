@@ -0,0 +1,118 @@
+// ConnectionPlanner against the all-pairs scan recalculateConnections() used
+// before it: the same connections, in the same order, on random groups with
+// shared topPixels, missing bottomPixels and 2/4-port intersections.
+
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "ConnectionPlanner.h"
+#include "HostTest.h"
+
+namespace {
+
+struct TestIntersection {
+  int id = 0;
+  uint16_t topPixel = 0;
+  int16_t bottomPixel = -1;
+  uint8_t numPorts = 4;
+  uint8_t used = 0;
+};
+
+using Pairs = std::vector<std::pair<int, int>>;
+
+bool hasPort(const TestIntersection* intersection) { return intersection->used < intersection->numPorts; }
+
+// Same rule as isIntersectionBlockingPath(), applied to every member.
+bool blocked(const std::vector<TestIntersection*>& members, const TestIntersection* a, const TestIntersection* b) {
+  const int low = std::min(a->topPixel, b->topPixel);
+  const int high = std::max(a->topPixel, b->topPixel);
+  for (const TestIntersection* test : members) {
+    if (test == a || test == b || test->topPixel <= low || test->topPixel >= high) continue;
+    if (a->bottomPixel != -1 && b->bottomPixel != -1 && test->bottomPixel != -1) {
+      const int bottomLow = std::min(a->bottomPixel, b->bottomPixel);
+      const int bottomHigh = std::max(a->bottomPixel, b->bottomPixel);
+      if (test->bottomPixel <= bottomLow || test->bottomPixel >= bottomHigh) continue;
+    }
+    return true;
+  }
+  return false;
+}
+
+void connect(Pairs& made, TestIntersection* a, TestIntersection* b) {
+  a->used++;
+  b->used++;
+  made.push_back({a->id, b->id});
+}
+
+Pairs allPairsScan(std::vector<TestIntersection*> members) {
+  Pairs made;
+  for (size_t i = 0; i < members.size(); i++) {
+    for (size_t j = i + 1; j < members.size(); j++) {
+      if (blocked(members, members[i], members[j])) continue;
+      if (hasPort(members[i]) && hasPort(members[j])) connect(made, members[i], members[j]);
+    }
+  }
+  return made;
+}
+
+Pairs planned(std::vector<TestIntersection*> members) {
+  Pairs made;
+  ConnectionPlanner planner;
+  planner.planGroup(members, hasPort, [&](TestIntersection* a, TestIntersection* b) { connect(made, a, b); });
+  return made;
+}
+
+void matchesAllPairsScan(unsigned seed, size_t count, int missingBottomPercent) {
+  std::srand(seed);
+  std::vector<TestIntersection> storage(count);
+  uint16_t top = 0;
+  for (size_t i = 0; i < count; i++) {
+    TestIntersection& intersection = storage[i];
+    intersection.id = static_cast<int>(i);
+    // Mostly increasing, as intersections are entered along the strip, with repeats.
+    top = static_cast<uint16_t>(top + std::rand() % 3);
+    intersection.topPixel = top;
+    intersection.bottomPixel = std::rand() % 100 < missingBottomPercent ? -1 : static_cast<int16_t>(std::rand() % 40);
+    intersection.numPorts = std::rand() % 2 ? 4 : 2;
+  }
+
+  std::vector<TestIntersection> scanStorage = storage;
+  std::vector<TestIntersection*> scanMembers;
+  std::vector<TestIntersection*> planMembers;
+  for (size_t i = 0; i < count; i++) {
+    scanMembers.push_back(&scanStorage[i]);
+    planMembers.push_back(&storage[i]);
+  }
+
+  const Pairs expected = allPairsScan(scanMembers);
+  const Pairs actual = planned(planMembers);
+  CHECK_EQ(actual.size(), expected.size());
+  CHECK(actual == expected);
+}
+
+void skipsAlreadyConnectedPairs() {
+  TestIntersection a{0, 10, 5, 2, 0};
+  TestIntersection b{1, 20, 9, 2, 0};
+  TestIntersection c{2, 30, 7, 2, 0};
+  std::vector<TestIntersection*> members{&c, &a, &b};
+  Pairs made;
+  ConnectionPlanner planner;
+  planner.planGroup(members, hasPort, [&](TestIntersection* x, TestIntersection* y) {
+    if (x->id == 0 && y->id == 1) return;  // already connected: no port used
+    connect(made, x, y);
+  });
+  // a keeps its ports, so it goes on past b (not blocking: bottom 9 is outside 5..7).
+  CHECK(made == (Pairs{{0, 2}, {1, 2}}));
+}
+
+}  // namespace
+
+int main() {
+  for (unsigned seed = 1; seed <= 300; seed++) {
+    matchesAllPairsScan(seed, 2 + seed % 60, 0);
+    matchesAllPairsScan(seed, 2 + seed % 60, 15);
+  }
+  skipsAlreadyConnectedPairs();
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,219 @@
+// JsonStreamReader on its own: the same values whether a body arrives in one
+// piece or a byte at a time, escapes, the number grammar, the depth and size
+// limits, over-long keys and values, and a sink stopping the read.
+
+#include <string>
+#include <vector>
+
+#include "HostTest.h"
+#include "JsonStreamReader.h"
+
+namespace {
+
+// Records every scalar as "path=value", with a '~' before truncated values.
+class RecordingSink : public JsonStreamSink {
+ public:
+  std::vector<std::string> values;
+  const char* rejectKey = nullptr;
+  bool documentEnded = false;
+
+  bool onValue(const JsonStreamPath& path, const JsonStreamValue& value) override {
+    if (rejectKey != nullptr && strcmp(path.key(), rejectKey) == 0) {
+      return false;
+    }
+    std::string entry = pathOf(path) + "=" + (value.truncated ? "~" : "");
+    switch (value.type) {
+      case JsonStreamValue::Text: entry += "\"" + std::string(value.text) + "\""; break;
+      case JsonStreamValue::Number: entry += value.text; break;
+      case JsonStreamValue::Bool: entry += value.boolean ? "true" : "false"; break;
+      case JsonStreamValue::Null: entry += "null"; break;
+    }
+    values.push_back(entry);
+    return true;
+  }
+
+  bool onDocumentEnd() override {
+    documentEnded = true;
+    return true;
+  }
+
+ private:
+  static std::string pathOf(const JsonStreamPath& path) {
+    if (path.parentIs("items[]")) return std::string("items[].") + path.key();
+    if (path.is("items[]")) return "items[]";
+    if (path.depth() == 1) return path.key();
+    return "?";
+  }
+};
+
+struct Result {
+  bool ok = false;
+  std::string error;
+  bool sinkRejected = false;
+  bool tooLarge = false;
+  std::vector<std::string> values;
+};
+
+Result read(const std::string& body, size_t chunk, size_t maxBytes = 0, const char* rejectKey = nullptr) {
+  RecordingSink sink;
+  sink.rejectKey = rejectKey;
+  JsonStreamReader reader;
+  reader.begin(&sink, maxBytes);
+  bool ok = true;
+  for (size_t offset = 0; ok && offset < body.size(); offset += chunk) {
+    const size_t length = std::min(chunk, body.size() - offset);
+    ok = reader.feed(body.data() + offset, length);
+  }
+  Result result;
+  result.ok = ok && reader.finish();
+  result.error = reader.error();
+  result.sinkRejected = reader.sinkRejected();
+  result.tooLarge = reader.tooLarge();
+  result.values = sink.values;
+  CHECK(!result.ok || sink.documentEnded);
+  return result;
+}
+
+// Whole body and byte-by-byte feeds must agree.
+Result readBothWays(const std::string& body, size_t maxBytes = 0) {
+  const Result whole = read(body, body.size() == 0 ? 1 : body.size(), maxBytes);
+  const Result bytes = read(body, 1, maxBytes);
+  CHECK(whole.ok == bytes.ok);
+  CHECK(whole.error == bytes.error);
+  CHECK(whole.values == bytes.values);
+  return bytes;
+}
+
+void readsPathsAcrossChunks() {
+  const Result result = readBothWays(
+      "{\"name\":\"a\\\"b\\\\c\\/\\n\",\"count\":-12,\"ratio\":0.5e-3,\"on\":true,\"off\":false,"
+      "\"none\":null,\"items\":[{\"id\":1},{\"id\":2,\"tags\":[3]}],\"u\":\"\\u00e9\\u20ac\"}");
+  CHECK(result.ok);
+  const std::vector<std::string> expected = {
+      "name=\"a\"b\\c/\n\"", "count=-12", "ratio=0.5e-3", "on=true", "off=false", "none=null",
+      "items[].id=1", "items[].id=2", "?=3", "u=\"\xC3\xA9\xE2\x82\xAC\""};
+  CHECK(result.values == expected);
+}
+
+void validatesNumbers() {
+  for (const char* valid : {"0", "-0", "10", "-1.25", "1e5", "1E+5", "2.5e-10", "0.0"}) {
+    const Result result = readBothWays(std::string("{\"v\":") + valid + "}");
+    CHECK(result.ok);
+    CHECK(result.values == std::vector<std::string>{std::string("v=") + valid});
+  }
+  for (const char* invalid : {"01", "-", "-nan", "nan", "1.", ".5", "1e", "1e+", "+1", "1.2.3", "0x10",
+                              "--1", "1-2", "Infinity", "tru", "nulll", "falsey"}) {
+    const Result result = readBothWays(std::string("{\"v\":") + invalid + "}");
+    CHECK(!result.ok);
+    CHECK(result.error == "Invalid JSON");
+    CHECK(result.values.empty());
+  }
+}
+
+void convertsNumbers() {
+  JsonStreamValue value;
+  value.type = JsonStreamValue::Number;
+  value.text = "1e999";
+  CHECK(value.toFloat(7.0f) == 7.0f);
+  long out = 0;
+  value.text = "42";
+  CHECK(value.toLong(0, 255, out));
+  CHECK_EQ(out, 42);
+  CHECK(!value.toLong(0, 40, out));
+  value.text = "4.5";
+  CHECK(!value.toLong(0, 255, out));
+  value.text = "42";
+  value.truncated = true;
+  CHECK(!value.toLong(0, 255, out));
+  CHECK(value.toFloat(-1.0f) == -1.0f);
+}
+
+void rejectsMalformedStructure() {
+  for (const char* invalid : {"", "{", "{\"a\"}", "{\"a\":1,}", "[1,]", "[1 2]", "{\"a\":1}}", "\"a\nb\"",
+                              "\"\\x\"", "\"\\u12g4\"", "{a:1}", "[1]x"}) {
+    const Result result = readBothWays(invalid);
+    CHECK(!result.ok);
+  }
+}
+
+void limitsDepth() {
+  std::string nested;
+  for (int i = 0; i < JSON_STREAM_MAX_DEPTH; i++) nested += "[";
+  for (int i = 0; i < JSON_STREAM_MAX_DEPTH; i++) nested += "]";
+  CHECK(readBothWays(nested).ok);
+
+  const Result tooDeep = readBothWays("[" + nested + "]");
+  CHECK(!tooDeep.ok);
+  CHECK(tooDeep.error == "JSON nested too deeply");
+}
+
+void limitsSize() {
+  const std::string body = "{\"count\":12345}";
+  CHECK(readBothWays(body, body.size()).ok);
+
+  const Result tooLarge = readBothWays(body, body.size() - 1);
+  CHECK(!tooLarge.ok);
+  CHECK(tooLarge.tooLarge);
+  CHECK(tooLarge.error == "JSON body too large");
+}
+
+void skipsLongKeysAndValues() {
+  const std::string longKey(JSON_STREAM_MAX_KEY + 10, 'k');
+  const std::string longText(JSON_STREAM_MAX_TOKEN + 50, 'x');
+  const std::string longNumber(JSON_STREAM_MAX_TOKEN + 50, '7');
+  const Result result = readBothWays("{\"" + longKey + "\":{\"id\":\"" + longText + "\"},\"name\":\"" + longText +
+                                     "\",\"count\":" + longNumber + ",\"items\":[{\"id\":5}]}");
+  CHECK(result.ok);
+  const std::string kept = longText.substr(0, JSON_STREAM_MAX_TOKEN);
+  // The member under the long key matches no path, not even "id".
+  const std::vector<std::string> expected = {"?=~\"" + kept + "\"", "name=~\"" + kept + "\"",
+                                             "count=~" + longNumber.substr(0, JSON_STREAM_MAX_TOKEN), "items[].id=5"};
+  CHECK(result.values == expected);
+
+  // The grammar still applies past the kept bytes.
+  const Result badTail = readBothWays("{\"count\":" + longNumber + ".}");
+  CHECK(!badTail.ok);
+  CHECK(badTail.error == "Invalid JSON");
+}
+
+void reportsSinkRejection() {
+  const Result whole = read("{\"count\":1,\"stop\":2,\"after\":3}", 64, 0, "stop");
+  const Result bytes = read("{\"count\":1,\"stop\":2,\"after\":3}", 1, 0, "stop");
+  for (const Result& result : {whole, bytes}) {
+    CHECK(!result.ok);
+    CHECK(result.sinkRejected);
+    CHECK(result.values == std::vector<std::string>{"count=1"});
+  }
+
+  // A parse error is not reported as the sink's.
+  const Result parseError = read("{\"count\":01}", 1, 0, "stop");
+  CHECK(!parseError.ok);
+  CHECK(!parseError.sinkRejected);
+}
+
+void reusesReader() {
+  RecordingSink sink;
+  JsonStreamReader reader;
+  reader.begin(&sink, 0);
+  CHECK(!reader.feed("{\"v\":-nan}", 10));
+  reader.begin(&sink, 0);
+  sink.values.clear();
+  CHECK(reader.feed("{\"v\":-1}", 8));
+  CHECK(reader.finish());
+  CHECK(sink.values == std::vector<std::string>{"v=-1"});
+}
+
+}  // namespace
+
+int main() {
+  readsPathsAcrossChunks();
+  validatesNumbers();
+  convertsNumbers();
+  rejectsMalformedStructure();
+  limitsDepth();
+  limitsSize();
+  skipsLongKeysAndValues();
+  reportsSinkRejection();
+  reusesReader();
+  return HOST_TEST_RESULT();
+}
@@ -0,0 +1,120 @@
+// OutputMap::build() and locate(): strip offsets in config order, strips with
+// no pixels skipped, per-strip type/order overrides, the 65535-pixel frame
+// limit and the backend's strip limit.
+
+#include "HostTest.h"
+#include "OutputMap.h"
+
+namespace {
+
+constexpr uint8_t DEFAULT_TYPE = 10;
+constexpr uint8_t DEFAULT_ORDER = 20;
+
+void laysOutStripsBackToBack() {
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  configs[0] = {100, 14};
+  configs[1] = {0, 26};  // skipped
+  configs[2] = {50, 27, 11, OUTPUT_INHERIT};
+  configs[5] = {200, 33, OUTPUT_INHERIT, 21};
+
+  OutputMap map;
+  map.build(configs, DEFAULT_TYPE, DEFAULT_ORDER);
+  CHECK_EQ(map.stripCount, 3);
+  CHECK_EQ(map.totalPixels, 350);
+  CHECK_EQ(map.longestStrip, 200);
+  CHECK(!map.truncated);
+  CHECK_EQ(map.droppedStrips, 0);
+
+  CHECK_EQ(map.strips[0].configIndex, 0);
+  CHECK_EQ(map.strips[0].start, 0);
+  CHECK_EQ(map.strips[0].count, 100);
+  CHECK_EQ(map.strips[0].pin, 14);
+  CHECK_EQ(map.strips[0].ledType, DEFAULT_TYPE);
+  CHECK_EQ(map.strips[0].colorOrder, DEFAULT_ORDER);
+
+  CHECK_EQ(map.strips[1].configIndex, 2);
+  CHECK_EQ(map.strips[1].start, 100);
+  CHECK_EQ(map.strips[1].count, 50);
+  CHECK_EQ(map.strips[1].ledType, 11);
+  CHECK_EQ(map.strips[1].colorOrder, DEFAULT_ORDER);
+
+  CHECK_EQ(map.strips[2].configIndex, 5);
+  CHECK_EQ(map.strips[2].start, 150);
+  CHECK_EQ(map.strips[2].ledType, DEFAULT_TYPE);
+  CHECK_EQ(map.strips[2].colorOrder, 21);
+  CHECK(map.hasMixedLedTypes());
+
+  uint16_t local = 0;
+  CHECK_EQ(map.locate(0, local), 0);
+  CHECK_EQ(local, 0);
+  CHECK_EQ(map.locate(99, local), 0);
+  CHECK_EQ(local, 99);
+  CHECK_EQ(map.locate(100, local), 1);
+  CHECK_EQ(local, 0);
+  CHECK_EQ(map.locate(349, local), 2);
+  CHECK_EQ(local, 199);
+  CHECK_EQ(map.locate(350, local), -1);
+}
+
+void handlesNoStrips() {
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  OutputMap map;
+  map.build(configs, DEFAULT_TYPE, DEFAULT_ORDER);
+  CHECK_EQ(map.stripCount, 0);
+  CHECK_EQ(map.totalPixels, 0);
+  CHECK(!map.hasMixedLedTypes());
+  uint16_t local = 0;
+  CHECK_EQ(map.locate(0, local), -1);
+}
+
+void truncatesAtFrameLimit() {
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  configs[0] = {60000, 1};
+  configs[1] = {10000, 2};
+  configs[2] = {500, 3};
+
+  OutputMap map;
+  map.build(configs, DEFAULT_TYPE, DEFAULT_ORDER);
+  CHECK(map.truncated);
+  CHECK_EQ(map.stripCount, 2);
+  CHECK_EQ(map.strips[1].count, OUTPUT_MAX_PIXELS - 60000);
+  CHECK_EQ(map.totalPixels, OUTPUT_MAX_PIXELS);
+  CHECK_EQ(map.longestStrip, 60000);
+
+  // Rebuilding clears the previous result.
+  configs[0].pixelCount = 10;
+  map.build(configs, DEFAULT_TYPE, DEFAULT_ORDER);
+  CHECK(!map.truncated);
+  CHECK_EQ(map.stripCount, 3);
+  CHECK_EQ(map.totalPixels, 10510);
+}
+
+void limitsStripCount() {
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  for (uint8_t i = 0; i < OUTPUT_MAX_STRIPS; i++) {
+    configs[i] = {static_cast<uint16_t>(10 * (i + 1)), i};
+  }
+  configs[1].pixelCount = 0;
+
+  OutputMap map;
+  map.build(configs, DEFAULT_TYPE, DEFAULT_ORDER, 2);
+  CHECK_EQ(map.stripCount, 2);
+  CHECK_EQ(map.droppedStrips, OUTPUT_MAX_STRIPS - 3);
+  CHECK_EQ(map.strips[1].configIndex, 2);
+  CHECK_EQ(map.totalPixels, 40);
+
+  map.build(configs, DEFAULT_TYPE, DEFAULT_ORDER);
+  CHECK_EQ(map.stripCount, OUTPUT_MAX_STRIPS - 1);
+  CHECK_EQ(map.droppedStrips, 0);
+  CHECK(!map.hasMixedLedTypes());
+}
+
+}  // namespace
+
+int main() {
+  laysOutStripsBackToBack();
+  handlesNoStrips();
+  truncatesAtFrameLimit();
+  limitsStripCount();
+  return HOST_TEST_RESULT();
+}
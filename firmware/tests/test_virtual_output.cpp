@@ -0,0 +1,172 @@
+// VirtualOutput configured from an OutputMap: frame layout per strip, the wire
+// order each configured colour order ends up with (the same RGB/GRB set the
+// FastLED and NeoPixelBus backends build), readPixel() undoing it, the
+// transfer-time model and the blocking reported by show().
+
+#include <cstdlib>
+#include <cstring>
+
+#include "HostTest.h"
+#include "OutputMap.h"
+#include "VirtualOutput.h"
+
+#ifdef VIRTUAL_OUTPUT_SOCKET_SUPPORTED
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct WireOrder {
+  uint8_t configured;
+  uint8_t expected[4];  // bytes sent for r=1, g=2, b=3, w=4
+  uint8_t bytesPerPixel;
+};
+
+// createNeoPixelBusStripWithMethod and FASTLED_ADD_CHIPSET build RGB, GRB, RGBW
+// and GRBW strips and fall back to GRB for every other order.
+constexpr WireOrder WIRE_ORDERS[] = {
+    {CO_RGB, {1, 2, 3, 0}, 3},
+    {CO_GRB, {2, 1, 3, 0}, 3},
+    {CO_BRG, {2, 1, 3, 0}, 3},
+    {CO_RBG, {2, 1, 3, 0}, 3},
+    {CO_BGR, {2, 1, 3, 0}, 3},
+    {CO_GBR, {2, 1, 3, 0}, 3},
+    {CO_RGBW, {1, 2, 3, 4}, 4},
+    {CO_GRBW, {2, 1, 3, 4}, 4},
+};
+
+void mapsColorOrdersLikeHardware() {
+  for (const WireOrder& order : WIRE_ORDERS) {
+    OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+    configs[0] = {4, 14, OUTPUT_INHERIT, order.configured};
+    OutputMap map;
+    map.build(configs, 0, CO_GRB);
+    VirtualStripTiming timings[OUTPUT_MAX_STRIPS];
+    VirtualOutput output;
+    output.configure(map, timings);
+
+    CHECK_EQ(output.strip(0).bytesPerPixel, order.bytesPerPixel);
+    CHECK_EQ(output.frameBytes(), 4u * order.bytesPerPixel);
+    output.setPixel(0, 1, 1, 2, 3, 4);
+    const uint8_t* pixel = output.frame() + order.bytesPerPixel;
+    for (uint8_t i = 0; i < order.bytesPerPixel; i++) {
+      CHECK_EQ(pixel[i], order.expected[i]);
+    }
+
+    uint8_t r = 0, g = 0, b = 0, w = 0;
+    CHECK(output.readPixel(1, r, g, b, w));
+    CHECK_EQ(r, 1);
+    CHECK_EQ(g, 2);
+    CHECK_EQ(b, 3);
+    CHECK_EQ(w, order.bytesPerPixel == 4 ? 4 : 0);
+  }
+}
+
+void laysOutStripsFromMap() {
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  configs[0] = {10, 14};
+  configs[1] = {0, 26};  // skipped by the map
+  configs[2] = {5, 27, OUTPUT_INHERIT, CO_GRBW};
+  OutputMap map;
+  map.build(configs, 0, CO_RGB);
+
+  VirtualStripTiming timings[OUTPUT_MAX_STRIPS];
+  timings[1].bitRateHz = 400000;
+  timings[1].resetMicros = 50;
+  VirtualOutput output;
+  output.configure(map, timings);
+
+  CHECK_EQ(output.stripCount(), 2);
+  CHECK_EQ(output.frameBytes(), 10 * 3 + 5 * 4);
+  CHECK_EQ(output.strip(0).byteOffset, 0);
+  CHECK_EQ(output.strip(1).byteOffset, 30);
+  CHECK_EQ(output.strip(1).start, 10);
+  CHECK_EQ(output.strip(0).wireMicros, 10 * 24 * 1000000 / 800000 + 300);
+  CHECK_EQ(output.strip(1).wireMicros, 5 * 32 * 1000000 / 400000 + 50);
+  CHECK_EQ(output.frameMicros(), output.strip(0).wireMicros);
+
+  // Every logical pixel lands on its strip, and nothing past the map does.
+  for (uint16_t pixel = 0; pixel < map.totalPixels; pixel++) {
+    uint16_t local = 0;
+    const int8_t strip = map.locate(pixel, local);
+    output.setPixel(static_cast<uint8_t>(strip), local, static_cast<uint8_t>(pixel), 100, 200, 50);
+  }
+  for (uint16_t pixel = 0; pixel < map.totalPixels; pixel++) {
+    uint8_t r = 0, g = 0, b = 0, w = 0;
+    CHECK(output.readPixel(pixel, r, g, b, w));
+    CHECK_EQ(r, pixel);
+    CHECK_EQ(w, pixel >= 10 ? 50 : 0);
+  }
+  uint8_t r = 0, g = 0, b = 0, w = 0;
+  CHECK(!output.readPixel(map.totalPixels, r, g, b, w));
+}
+
+void reportsBlockedShows() {
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  configs[0] = {100, 14};
+  OutputMap map;
+  map.build(configs, 0, CO_GRB);
+  VirtualStripTiming timings[OUTPUT_MAX_STRIPS];
+  VirtualOutput output;
+  output.configure(map, timings);
+
+  const uint32_t frame = output.frameMicros();
+  CHECK_EQ(output.show(1000), 0);
+  CHECK(!output.canShow(1000 + frame - 1));
+  CHECK_EQ(output.show(1100), frame - 100);
+  CHECK(output.canShow(1000 + 2 * frame));
+  CHECK_EQ(output.show(1000 + 3 * frame), 0);
+  CHECK_EQ(output.frames, 3);
+  CHECK_EQ(output.blockedMicros, frame - 100);
+  CHECK_EQ(output.totalWireMicros, 3ull * frame);
+}
+
+void mirrorsFrames() {
+#ifdef VIRTUAL_OUTPUT_SOCKET_SUPPORTED
+  OutputStripConfig configs[OUTPUT_MAX_STRIPS] = {};
+  configs[0] = {10, 14};
+  configs[1] = {5, 26, OUTPUT_INHERIT, CO_GRBW};
+  OutputMap map;
+  map.build(configs, 0, CO_GRB);
+  VirtualStripTiming timings[OUTPUT_MAX_STRIPS];
+  VirtualOutput output;
+  output.configure(map, timings);
+  output.show(0);
+
+  char path[] = "/tmp/meshled_vo_XXXXXX";
+  const int tmp = mkstemp(path);
+  CHECK(tmp >= 0);
+  ::close(tmp);
+  ::unlink(path);
+  const int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+  CHECK(::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+
+  VirtualOutputMirror mirror;
+  CHECK(mirror.open(path));
+  mirror.send(output);
+  uint8_t packet[512];
+  const ssize_t received = ::recv(fd, packet, sizeof(packet), MSG_DONTWAIT);
+  CHECK_EQ(received, 4 + 4 + 4 + 1 + 2 * 6 + 50);
+  CHECK(std::memcmp(packet, "MLVF", 4) == 0);
+  CHECK_EQ(packet[4], 1);
+  CHECK_EQ(packet[12], 2);
+  CHECK_EQ(mirror.dropped, 0);
+  ::close(fd);
+  ::unlink(path);
+#endif
+}
+
+}  // namespace
+
+int main() {
+  mapsColorOrdersLikeHardware();
+  laysOutStripsFromMap();
+  reportsBlockedShows();
+  mirrorsFrames();
+  return HOST_TEST_RESULT();
+}
@@ -12,6 +12,16 @@ configure_compiler() {
   fi
 }
 
+# Runs the core benchmark through the core's budget check, like the CI
+# guardrail job. LIGHTGRAPH_MIN_BENCHMARK_FPS sets the minimum accepted rate.
+run_benchmarks() {
+  local build_dir="$1"
+
+  echo "==> Running core benchmark (min fps: ${LIGHTGRAPH_MIN_BENCHMARK_FPS:-1000})"
+  LIGHTGRAPH_MIN_BENCHMARK_FPS="${LIGHTGRAPH_MIN_BENCHMARK_FPS:-1000}" \
+    "$CORE_DIR/scripts/check-benchmark.sh" "$build_dir/lightgraph_core_benchmark"
+}
+
 run_profile() {
   local profile="$1"
   local build_dir="$CORE_DIR/build"
@@ -37,8 +47,12 @@ run_profile() {
       build_dir="$CORE_DIR/build-warnings"
       cmake_args+=(-DLIGHTGRAPH_CORE_ENABLE_STRICT_WARNINGS=ON)
       ;;
+    bench)
+      build_dir="$CORE_DIR/build-bench"
+      cmake_args=(-DLIGHTGRAPH_CORE_BUILD_BENCHMARKS=ON -DLIGHTGRAPH_CORE_BUILD_TESTS=OFF -DCMAKE_BUILD_TYPE=Release)
+      ;;
     *)
-      echo "Unknown profile '$profile'. Expected: default|asan|ubsan|warnings|all" >&2
+      echo "Unknown profile '$profile'. Expected: default|asan|ubsan|warnings|bench|all" >&2
       exit 1
       ;;
   esac
@@ -46,7 +60,13 @@ run_profile() {
   echo "==> Configuring core profile '$profile' in '$build_dir'"
   cmake -S "$CORE_DIR" -B "$build_dir" "${cmake_args[@]}"
   echo "==> Building core profile '$profile'"
+  if [[ "$profile" == "bench" ]]; then
+    cmake --build "$build_dir" --target lightgraph_core_benchmark --parallel
+    run_benchmarks "$build_dir"
+    return
+  fi
   cmake --build "$build_dir"
+
   echo "==> Testing core profile '$profile'"
   ctest --test-dir "$build_dir" --output-on-failure
 }